@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_af_follow.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+static const uint RDS_POLL_INTERVAL_MS = 20;
+
+// block A must be error free or have 1-2 corrected errors, so a noisy PI isn't mistaken for a match
+static const uint8_t MAX_PI_BLOCK_ERRORS = 1;
+
+//
+// candidates
+//
+
+static bool fm_af_follow_is_weak(fm_af_follow_t *af_follow, const fm_status_t *status) {
+    return status->rssi < af_follow->config.min_rssi || status->bler[0] == 3 /* PI uncorrectable */;
+}
+
+static uint8_t fm_af_follow_find_rssi(const fm_af_follow_t *af_follow, uint8_t alt_freq) {
+    for (size_t i = 0; i < af_follow->candidate_count; i++) {
+        if (af_follow->candidates[i].alt_freq == alt_freq) {
+            return af_follow->candidates[i].rssi;
+        }
+    }
+    return 0;
+}
+
+static void fm_af_follow_load_candidates(fm_af_follow_t *af_follow, const rds_parser_t *parser) {
+    fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(af_follow->radio);
+    fm_af_follow_candidate_t candidates[FM_AF_FOLLOW_MAX_CANDIDATES];
+    size_t count = 0;
+
+    size_t alt_freq_count = rds_get_alternative_frequency_count(parser);
+    for (size_t i = 0; i < alt_freq_count && count < FM_AF_FOLLOW_MAX_CANDIDATES; i++) {
+        uint8_t alt_freq = rds_get_alternative_frequency(parser, i);
+        uint16_t frequency = rds_decode_alternative_frequency_10khz(alt_freq);
+        if (frequency == af_follow->home_frequency || frequency < range.bottom || range.top < frequency
+            || (frequency - range.bottom) % range.spacing != 0) {
+            continue; // not reachable with the current band and spacing
+        }
+        fm_af_follow_candidate_t candidate = {alt_freq, fm_af_follow_find_rssi(af_follow, alt_freq)};
+
+        // insertion sort, strongest first; unprobed candidates stay in frequency order
+        size_t j = count++;
+        for (; j > 0 && candidates[j - 1].rssi < candidate.rssi; j--) {
+            candidates[j] = candidates[j - 1];
+        }
+        candidates[j] = candidate;
+    }
+
+    memcpy(af_follow->candidates, candidates, count * sizeof(fm_af_follow_candidate_t));
+    af_follow->candidate_count = (uint8_t)count;
+    af_follow->candidate_index = 0;
+}
+
+//
+// probing
+//
+
+static void fm_af_follow_end_gap(fm_af_follow_t *af_follow, uint64_t now) {
+    if (af_follow->restore_mute) {
+        fm_set_mute(af_follow->radio, false);
+    }
+    uint32_t gap_us = (uint32_t)(now - af_follow->mute_time);
+    af_follow->last_gap_us = gap_us;
+    if (af_follow->max_gap_us < gap_us) {
+        af_follow->max_gap_us = gap_us;
+    }
+    af_follow->weak_count = 0;
+    af_follow->state = FM_AF_FOLLOW_MONITOR;
+}
+
+static uint64_t fm_af_follow_window_end(const fm_af_follow_t *af_follow) {
+    return af_follow->mute_time + af_follow->config.max_mute_ms * 1000ull;
+}
+
+static void fm_af_follow_probe_next(fm_af_follow_t *af_follow, uint64_t now) {
+    si470x_t *radio = af_follow->radio;
+    bool window_open = now < fm_af_follow_window_end(af_follow);
+    if (window_open && af_follow->candidate_index < af_follow->candidate_count) {
+        uint8_t alt_freq = af_follow->candidates[af_follow->candidate_index].alt_freq;
+        fm_set_frequency_10khz_async(radio, rds_decode_alternative_frequency_10khz(alt_freq));
+        af_follow->probe_count++;
+        af_follow->state = FM_AF_FOLLOW_PROBE_TUNE;
+    } else {
+        fm_set_frequency_10khz_async(radio, af_follow->home_frequency);
+        af_follow->state = FM_AF_FOLLOW_RETURN_TUNE;
+    }
+}
+
+static void fm_af_follow_reject(fm_af_follow_t *af_follow, uint64_t now) {
+    af_follow->candidate_index++;
+    fm_af_follow_probe_next(af_follow, now);
+}
+
+static bool fm_af_follow_start(fm_af_follow_t *af_follow, const rds_parser_t *parser, uint64_t now) {
+    si470x_t *radio = af_follow->radio;
+    fm_status_t status;
+    fm_get_status(radio, &status);
+    if (!fm_af_follow_is_weak(af_follow, &status)) {
+        af_follow->weak_count = 0;
+        return false;
+    }
+    if (++af_follow->weak_count < af_follow->config.weak_checks) {
+        return false; // may be a short fade
+    }
+    uint16_t pi = rds_get_program_id(parser);
+    if (pi == 0) {
+        return false; // nothing to verify candidates against
+    }
+    af_follow->home_frequency = fm_get_frequency_10khz(radio);
+    af_follow->home_rssi = status.rssi;
+    fm_af_follow_load_candidates(af_follow, parser);
+    if (af_follow->candidate_count == 0) {
+        return false;
+    }
+    af_follow->pi = pi;
+    af_follow->restore_mute = !fm_get_mute(radio);
+    fm_set_mute(radio, true);
+    af_follow->mute_time = now;
+    fm_af_follow_probe_next(af_follow, now);
+    return true;
+}
+
+static fm_af_follow_event_t fm_af_follow_tick_probe_tune(fm_af_follow_t *af_follow, uint64_t now) {
+    si470x_t *radio = af_follow->radio;
+    fm_async_progress_t progress = fm_async_task_tick(radio);
+    if (!progress.done) {
+        if (fm_af_follow_window_end(af_follow) <= now) {
+            fm_async_task_cancel(radio);
+            fm_af_follow_probe_next(af_follow, now); // returns home
+        }
+        return FM_AF_FOLLOW_NONE;
+    }
+    // the tune task has just read the status, no extra transfer unless the cache is disabled
+    fm_status_t status;
+    fm_get_status(radio, &status);
+    fm_af_follow_candidate_t *candidate = &af_follow->candidates[af_follow->candidate_index];
+    candidate->rssi = status.rssi;
+
+    uint8_t min_rssi = af_follow->home_rssi + af_follow->config.rssi_margin;
+    if (min_rssi < af_follow->config.min_rssi) {
+        min_rssi = af_follow->config.min_rssi;
+    }
+    if (progress.result < 0 || status.rssi < min_rssi) {
+        fm_af_follow_reject(af_follow, now); // not worth waiting for RDS
+    } else {
+        // a PI wait may not extend the gap past the mute window
+        af_follow->deadline = MIN(now + af_follow->config.pi_timeout_ms * 1000ull, fm_af_follow_window_end(af_follow));
+        af_follow->next_time = now;
+        af_follow->state = FM_AF_FOLLOW_PROBE_PI;
+    }
+    return FM_AF_FOLLOW_NONE;
+}
+
+static fm_af_follow_event_t fm_af_follow_tick_probe_pi(fm_af_follow_t *af_follow, uint64_t now) {
+    si470x_t *radio = af_follow->radio;
+    if (radio->async.task == NULL) {
+        if (af_follow->deadline <= now) {
+            fm_af_follow_reject(af_follow, now);
+            return FM_AF_FOLLOW_NONE;
+        }
+        if (now < af_follow->next_time) {
+            return FM_AF_FOLLOW_NONE;
+        }
+        // with interrupts, the read only checks a flag until a group is signaled
+        uint interval_ms = radio->irq_enabled ? 0 : RDS_POLL_INTERVAL_MS;
+        af_follow->next_time = now + interval_ms * 1000;
+        fm_read_rds_group_async(radio, af_follow->rds_blocks);
+    }
+
+    fm_async_progress_t progress = fm_async_task_tick(radio);
+    if (!progress.done || progress.result != 1) {
+        return FM_AF_FOLLOW_NONE;
+    }
+    uint8_t bler[4];
+    fm_get_rds_block_errors(radio, bler);
+    if (MAX_PI_BLOCK_ERRORS < bler[0]) {
+        return FM_AF_FOLLOW_NONE; // wait for a cleaner group
+    }
+    if (af_follow->rds_blocks[0] != af_follow->pi) {
+        fm_af_follow_reject(af_follow, now); // different program
+        return FM_AF_FOLLOW_NONE;
+    }
+    af_follow->switch_count++;
+    fm_af_follow_end_gap(af_follow, now);
+    return FM_AF_FOLLOW_SWITCHED;
+}
+
+static fm_af_follow_event_t fm_af_follow_tick_return_tune(fm_af_follow_t *af_follow, uint64_t now) {
+    fm_async_progress_t progress = fm_async_task_tick(af_follow->radio);
+    if (!progress.done) {
+        return FM_AF_FOLLOW_NONE;
+    }
+    fm_af_follow_end_gap(af_follow, now);
+    af_follow->next_time = now + af_follow->config.retry_interval_ms * 1000ull;
+    return FM_AF_FOLLOW_RETURNED;
+}
+
+//
+// public interface
+//
+
+void fm_af_follow_init(fm_af_follow_t *af_follow, si470x_t *radio, fm_af_follow_config_t config) {
+    assert(0 < config.check_interval_ms);
+
+    memset(af_follow, 0, sizeof(fm_af_follow_t));
+
+    af_follow->radio = radio;
+    af_follow->config = config;
+    af_follow->state = FM_AF_FOLLOW_MONITOR;
+}
+
+fm_af_follow_event_t fm_af_follow_tick(fm_af_follow_t *af_follow, const rds_parser_t *parser) {
+    si470x_t *radio = af_follow->radio;
+    uint64_t now = time_us_64();
+
+    switch (af_follow->state) {
+    case FM_AF_FOLLOW_MONITOR:
+        if (now < af_follow->next_time || !fm_is_powered_up(radio) || radio->async.task != NULL) {
+            return FM_AF_FOLLOW_NONE;
+        }
+        af_follow->next_time = now + af_follow->config.check_interval_ms * 1000ull;
+        fm_af_follow_start(af_follow, parser, now);
+        return FM_AF_FOLLOW_NONE;
+    case FM_AF_FOLLOW_PROBE_TUNE:
+        return fm_af_follow_tick_probe_tune(af_follow, now);
+    case FM_AF_FOLLOW_PROBE_PI:
+        return fm_af_follow_tick_probe_pi(af_follow, now);
+    case FM_AF_FOLLOW_RETURN_TUNE:
+        return fm_af_follow_tick_return_tune(af_follow, now);
+    }
+    return FM_AF_FOLLOW_NONE;
+}
+
+void fm_af_follow_abort(fm_af_follow_t *af_follow) {
+    si470x_t *radio = af_follow->radio;
+    if (fm_af_follow_is_busy(af_follow)) {
+        fm_async_task_cancel(radio);
+        fm_set_frequency_10khz_blocking(radio, af_follow->home_frequency);
+        fm_af_follow_end_gap(af_follow, time_us_64());
+    }
+    af_follow->weak_count = 0;
+    af_follow->candidate_count = 0;
+    af_follow->next_time = 0;
+}
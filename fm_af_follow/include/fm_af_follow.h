@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_AF_FOLLOW_H_
+#define _FM_AF_FOLLOW_H_
+
+#include <fm_si470x.h>
+#include <rds_parser.h>
+
+#if !RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+#error "fm_af_follow requires RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_af_follow.h
+ *
+ * \brief Automatic alternative frequency following.
+ *
+ * Watches the signal of the current station, and when it stays weak, looks for the same
+ * program on the alternative frequencies broadcast over RDS. Audio is muted while candidates
+ * are probed. Each candidate is tuned with fm_set_frequency_10khz_async(), and rejected on
+ * RSSI alone before waiting for RDS. A candidate is accepted once block A of an RDS group
+ * carries the PI of the original station. If no candidate qualifies before the mute window
+ * runs out, the radio returns to the original frequency.
+ *
+ * Candidates are tried strongest first, by the RSSI measured on previous attempts, so a
+ * repeated switch usually costs a single tune.
+ *
+ * Usage:
+ *
+ *     fm_af_follow_init(&af_follow, &radio, fm_af_follow_default_config());
+ *     while (true) {
+ *         fm_af_follow_event_t event = fm_af_follow_tick(&af_follow, &rds_parser);
+ *         if (event == FM_AF_FOLLOW_SWITCHED) {
+ *             rds_parser_set_tuned_frequency_10khz(&rds_parser, fm_get_frequency_10khz(&radio));
+ *         }
+ *         if (!fm_af_follow_is_busy(&af_follow)) {
+ *             // read RDS groups into rds_parser, handle user input...
+ *         }
+ *         sleep_ms(5);
+ *     }
+ */
+
+#ifndef FM_AF_FOLLOW_MAX_CANDIDATES
+#define FM_AF_FOLLOW_MAX_CANDIDATES 25
+#endif
+
+/**
+ * \brief AF following parameters.
+ */
+typedef struct fm_af_follow_config_t
+{
+    uint8_t min_rssi; /**< Signal is weak below this RSSI (dBuV). */
+    uint8_t rssi_margin; /**< A candidate must beat the current RSSI by this much. */
+    uint8_t weak_checks; /**< Consecutive weak checks needed to start probing. */
+    uint16_t check_interval_ms; /**< Time between signal checks. */
+    uint16_t pi_timeout_ms; /**< Time to wait for a valid PI on a candidate. */
+    uint16_t max_mute_ms; /**< Longest audio gap spent probing. Returning home adds one tune on top. */
+    uint16_t retry_interval_ms; /**< Time to wait after a failed attempt. */
+} fm_af_follow_config_t;
+
+static inline fm_af_follow_config_t fm_af_follow_default_config() {
+    return (fm_af_follow_config_t){
+        .min_rssi = 20,
+        .rssi_margin = 6,
+        .weak_checks = 3,
+        .check_interval_ms = 250,
+        .pi_timeout_ms = 250, // PI repeats in every group, 87.6ms apart
+        .max_mute_ms = 600,
+        .retry_interval_ms = 10000,
+    };
+}
+
+/**
+ * \brief Result of fm_af_follow_tick().
+ */
+typedef enum fm_af_follow_event_t
+{
+    FM_AF_FOLLOW_NONE, /**< Nothing happened. */
+    FM_AF_FOLLOW_SWITCHED, /**< Now tuned to an alternative frequency with the same PI. */
+    FM_AF_FOLLOW_RETURNED, /**< No usable alternative, tuned back to the original frequency. */
+} fm_af_follow_event_t;
+
+// private
+typedef enum fm_af_follow_state_t
+{
+    FM_AF_FOLLOW_MONITOR,
+    FM_AF_FOLLOW_PROBE_TUNE,
+    FM_AF_FOLLOW_PROBE_PI,
+    FM_AF_FOLLOW_RETURN_TUNE,
+} fm_af_follow_state_t;
+
+// private
+typedef struct fm_af_follow_candidate_t
+{
+    uint8_t alt_freq; // raw AF value
+    uint8_t rssi; // last measured, 0 if never probed
+} fm_af_follow_candidate_t;
+
+/**
+ * \brief AF follower state.
+ */
+typedef struct fm_af_follow_t
+{
+    si470x_t *radio;
+    fm_af_follow_config_t config;
+    fm_af_follow_state_t state;
+    uint8_t weak_count;
+    uint16_t pi; // program being followed
+    uint16_t home_frequency;
+    uint8_t home_rssi;
+    bool restore_mute; // unmute when done
+    fm_af_follow_candidate_t candidates[FM_AF_FOLLOW_MAX_CANDIDATES];
+    uint8_t candidate_count;
+    uint8_t candidate_index;
+    uint16_t rds_blocks[4];
+    uint64_t mute_time; // start of the audio gap
+    uint64_t deadline; // end of the PI wait
+    uint64_t next_time; // next signal check or RDS read
+    uint32_t switch_count; /**< Successful switches. */
+    uint32_t probe_count; /**< Candidates tuned. */
+    uint32_t last_gap_us; /**< Duration of the last audio gap. */
+    uint32_t max_gap_us; /**< Longest audio gap. */
+} fm_af_follow_t;
+
+/**
+ * \brief Initialize the AF follower.
+ *
+ * @param af_follow AF follower.
+ * @param radio Radio handle. Need not be powered up yet.
+ * @param config Parameters, e.g. fm_af_follow_default_config().
+ */
+void fm_af_follow_init(fm_af_follow_t *af_follow, si470x_t *radio, fm_af_follow_config_t config);
+
+/**
+ * \brief Check the signal and advance probing.
+ *
+ * Should be called every few milliseconds, since the probing latency depends on it. While
+ * monitoring, the signal is checked every check_interval_ms and only while the radio has no
+ * async task. While probing, the follower owns the radio: it runs its own async tasks and
+ * ticks them, so the application must not tune, read RDS, or tick tasks until
+ * fm_af_follow_is_busy() returns false.
+ *
+ * After FM_AF_FOLLOW_SWITCHED the RDS parser may be kept, since the program is the same.
+ *
+ * @param af_follow AF follower.
+ * @param parser RDS parser of the current station, for the PI and AF list.
+ * @return Event.
+ */
+fm_af_follow_event_t fm_af_follow_tick(fm_af_follow_t *af_follow, const rds_parser_t *parser);
+
+/**
+ * \brief Check if the follower is probing alternative frequencies.
+ *
+ * @param af_follow AF follower.
+ */
+static inline bool fm_af_follow_is_busy(const fm_af_follow_t *af_follow) {
+    return af_follow->state != FM_AF_FOLLOW_MONITOR;
+}
+
+/**
+ * \brief Stop probing, and return to the original frequency right away.
+ *
+ * Should be called before the application tunes or powers down the radio. Also resets the
+ * candidate RSSI history, since it belongs to the old station.
+ *
+ * @param af_follow AF follower.
+ */
+void fm_af_follow_abort(fm_af_follow_t *af_follow);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_AF_FOLLOW_H_
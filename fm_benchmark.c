@@ -0,0 +1,175 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_rds.h>
+#include <fm_si470x.h>
+#include <rds_parser.h>
+#include <hardware/i2c.h>
+#include <pico/stdlib.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+// Measures the cost of driver operations. Each operation runs for a number of iterations,
+// and the results are printed as CSV on stdout:
+//
+//   op,iterations,min_us,avg_us,max_us,i2c_read_bytes,i2c_write_bytes
+//
+// Byte counts are per iteration and include the I2C address byte of each transfer. They are
+// collected by wrapping the blocking Pico SDK I2C calls at link time (see CMakeLists.txt).
+
+static const uint RESET_PIN = 15;
+static const uint SDIO_PIN = PICO_DEFAULT_I2C_SDA_PIN;
+static const uint SCLK_PIN = PICO_DEFAULT_I2C_SCL_PIN;
+
+static const float TUNE_FREQUENCIES[] = {
+    88.8f,
+    101.0f,
+};
+
+#define FM_CONFIG fm_config_europe()
+
+static si470x_t radio;
+static rds_parser_t rds_parser;
+
+//
+// I2C byte counters
+//
+
+static uint32_t i2c_read_bytes;
+static uint32_t i2c_write_bytes;
+
+int __real_i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+int __real_i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+int __wrap_i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    i2c_read_bytes += 1 + len;
+    return __real_i2c_read_blocking(i2c, addr, dst, len, nostop);
+}
+
+int __wrap_i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    i2c_write_bytes += 1 + len;
+    return __real_i2c_write_blocking(i2c, addr, src, len, nostop);
+}
+
+//
+// benchmark
+//
+
+typedef void (*bench_setup_t)(uint iteration);
+typedef void (*bench_op_t)(uint iteration);
+
+static void bench_run(const char *name, uint iterations, bench_setup_t setup, bench_op_t op) {
+    uint64_t min_us = UINT64_MAX;
+    uint64_t max_us = 0;
+    uint64_t total_us = 0;
+    uint64_t total_read_bytes = 0;
+    uint64_t total_write_bytes = 0;
+
+    for (uint i = 0; i < iterations; i++) {
+        if (setup != NULL) {
+            setup(i); // not measured
+        }
+        i2c_read_bytes = 0;
+        i2c_write_bytes = 0;
+
+        uint64_t start = time_us_64();
+        op(i);
+        uint64_t elapsed = time_us_64() - start;
+
+        total_read_bytes += i2c_read_bytes;
+        total_write_bytes += i2c_write_bytes;
+        total_us += elapsed;
+        if (elapsed < min_us) {
+            min_us = elapsed;
+        }
+        if (max_us < elapsed) {
+            max_us = elapsed;
+        }
+    }
+
+    printf("%s,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n",
+        name,
+        iterations,
+        min_us,
+        total_us / iterations,
+        max_us,
+        total_read_bytes / iterations,
+        total_write_bytes / iterations);
+}
+
+static void bench_power_down(uint iteration) {
+    (void)iteration;
+    fm_power_down(&radio);
+}
+
+static void bench_power_up(uint iteration) {
+    (void)iteration;
+    fm_power_up(&radio, FM_CONFIG);
+}
+
+static void bench_tune(uint iteration) {
+    // alternate, since tuning to the current frequency is a no-op
+    fm_set_frequency_blocking(&radio, TUNE_FREQUENCIES[(iteration + 1) % count_of(TUNE_FREQUENCIES)]);
+}
+
+static void bench_seek(uint iteration) {
+    (void)iteration;
+    fm_seek_blocking(&radio, FM_SEEK_UP);
+}
+
+static void bench_get_rssi(uint iteration) {
+    (void)iteration;
+    fm_get_rssi(&radio);
+}
+
+static void bench_read_rds_group(uint iteration) {
+    (void)iteration;
+    uint16_t blocks[4];
+    fm_read_rds_group(&radio, blocks);
+}
+
+static void bench_read_and_parse_rds(uint iteration) {
+    (void)iteration;
+    fm_read_and_parse_rds(&radio, &rds_parser, NULL);
+}
+
+static void bench_rds_parser_update(uint iteration) {
+    // synthetic group 0A, cycling through PS segments
+    rds_group_t group = {
+        .a = 0x1234,
+        .b = 0x0000 | (iteration & 0x3),
+        .c = 0xE0CD,
+        .d = 0x4142,
+    };
+    rds_parser_update(&rds_parser, &group);
+}
+
+int main() {
+    stdio_init_all();
+    sleep_ms(2000); // give USB serial time to connect
+
+    // Si470X supports up to 400kHz SCLK frequency
+    i2c_init(i2c_default, 400 * 1000);
+
+    fm_init(&radio, i2c_default, RESET_PIN, SDIO_PIN, SCLK_PIN, true /* enable_pull_ups */);
+    fm_power_up(&radio, FM_CONFIG);
+    fm_set_frequency_blocking(&radio, TUNE_FREQUENCIES[0]);
+    rds_parser_reset(&rds_parser);
+
+    puts("op,iterations,min_us,avg_us,max_us,i2c_read_bytes,i2c_write_bytes");
+    bench_run("power_up", 5, bench_power_down, bench_power_up);
+    bench_run("tune", 50, NULL, bench_tune);
+    bench_run("seek", 10, NULL, bench_seek);
+    bench_run("get_rssi", 1000, NULL, bench_get_rssi);
+    bench_run("read_rds_group", 1000, NULL, bench_read_rds_group);
+    bench_run("read_and_parse_rds", 1000, NULL, bench_read_and_parse_rds);
+    bench_run("rds_parser_update", 10000, NULL, bench_rds_parser_update);
+    puts("done");
+
+    do {
+        sleep_ms(1000);
+    } while (true);
+}
@@ -4,16 +4,35 @@
  * SPDX-License-Identifier: MIT
  */
 
+#include <fm_af_follow.h>
+#include <fm_rds.h>
+#include <fm_scanner.h>
 #include <fm_si470x.h>
+#include <fm_signal_monitor.h>
+#include <fm_station_db.h>
+#include <fm_ta_monitor.h>
+#include <rds_capture.h>
+#include <rds_group_queue.h>
 #include <rds_parser.h>
 #include <hardware/i2c.h>
+#include <pico/stdio_usb.h>
 #include <pico/stdlib.h>
 #include <stdio.h>
+#include <tusb.h>
 
 static const uint RESET_PIN = 15;
 static const uint SDIO_PIN = PICO_DEFAULT_I2C_SDA_PIN;
 static const uint SCLK_PIN = PICO_DEFAULT_I2C_SCL_PIN;
 
+// connect Si470x GPIO2 and set this to a pin number for interrupt-driven RDS, or leave -1 to poll
+static const int GPIO2_PIN = -1;
+
+// connect a second Si4703 on i2c1 and set this to its reset pin, to keep the station database
+// fresh in the background, or leave -1
+static const int SCANNER_RESET_PIN = -1;
+static const uint SCANNER_SDIO_PIN = 2;
+static const uint SCANNER_SCLK_PIN = 3;
+
 // change this to match your local stations
 static const float STATION_PRESETS[] = {
     88.8f, // Radio Romania Actualitati
@@ -32,19 +51,35 @@ static_assert(count_of(STATION_PRESETS) <= 9, "");
 
 static si470x_t radio;
 static rds_parser_t rds_parser;
+static rds_group_queue_t rds_queue;
+static fm_af_follow_t af_follow;
+static fm_station_db_t station_db;
+static rds_capture_t rds_capture;
+static fm_signal_monitor_t signal_monitor;
+static si470x_t scanner_radio;
+static fm_scanner_t scanner;
+static fm_ta_monitor_t ta_monitor;
+static bool af_follow_enabled = false;
+static bool rds_capture_enabled = false;
 
 static void print_help() {
     puts("Si470X - test program");
     puts("=====================");
     puts("- =   Volume down / up");
-    puts("1-9   Station presets");
+    puts("1-9   Station presets (scanned stations, if any)");
     puts("{ }   Frequency down / up");
     puts("[ ]   Seek down / up");
+    puts("a     Scan band");
     puts("s     Toggle seek sensitivity");
     puts("0     Toggle mute");
     puts("f     Toggle softmute");
     puts("m     Toggle mono");
+    puts("o     Toggle AF following");
+    puts("v     Toggle RDS verbose mode");
+    puts("c     Toggle RDS capture (binary stream on USB)");
+    puts("t     Sleep until a traffic announcement (needs GPIO2)");
     puts("i     Print station info");
+    puts("q     Print signal quality");
     puts("r     Print RDS info");
     puts("x     Power down");
     puts("?     Print help");
@@ -52,10 +87,29 @@ static void print_help() {
 }
 
 static void print_station_info() {
+    fm_status_t status;
+    fm_get_status(&radio, &status); // single read for RSSI and stereo
     printf("%.2f MHz, RSSI: %u, stereo: %u\n",
         fm_get_frequency(&radio),
-        fm_get_rssi(&radio),
-        fm_get_stereo_indicator(&radio));
+        status.rssi,
+        status.stereo);
+}
+
+static void print_signal_quality() {
+    fm_signal_stats_t stats;
+    fm_signal_monitor_get_stats(&signal_monitor, &stats);
+    printf("RSSI over %u samples: min %u, p10 %u, median %u, mean %u, max %u\n",
+        stats.sample_count,
+        stats.rssi_min,
+        fm_signal_monitor_get_rssi_percentile(&signal_monitor, 10),
+        stats.rssi_median,
+        stats.rssi_mean,
+        stats.rssi_max);
+    printf("Stereo: %u%%, RDS synced: %u%%, block errors: %u%% of %u groups\n",
+        stats.stereo_percent,
+        stats.rds_synced_percent,
+        stats.block_error_percent,
+        stats.rds_group_count);
 }
 
 static void print_rds_info() {
@@ -97,16 +151,42 @@ static void print_rds_info() {
 }
 
 static void update_rds() {
-    union
-    {
-        uint16_t group_data[4];
-        rds_group_t group;
-    } rds;
-    if (fm_read_rds_group(&radio, rds.group_data)) {
-        rds_parser_update(&rds_parser, &rds.group);
+    // capture - this side could also run in an IRQ or on core1
+    fm_read_rds_into_queue(&radio, &rds_queue);
+
+    // parse in batches
+    rds_group_entry_t entries[4];
+    size_t count;
+    while ((count = rds_group_queue_pop_batch(&rds_queue, entries, count_of(entries))) != 0) {
+        if (rds_capture_enabled) {
+            uint8_t rssi = fm_get_rssi(&radio); // once per batch
+            for (size_t i = 0; i < count; i++) {
+                rds_capture_add(&rds_capture, &entries[i], fm_get_frequency_10khz(&radio), rssi);
+            }
+        }
+        for (size_t i = 0; i < count; i++) {
+            uint32_t changes = rds_parser_update_with_errors(&rds_parser, &entries[i].group, entries[i].bler);
+            if (changes & (RDS_CHANGE_PI | RDS_CHANGE_PS | RDS_CHANGE_AF)) {
+                // kept in RAM, persisted on power down or after a scan
+                fm_station_db_update(&station_db, fm_get_frequency_10khz(&radio), fm_get_rssi(&radio), &rds_parser);
+            }
+        }
     }
 }
 
+static size_t write_usb(void *context, const uint8_t *data, size_t len) {
+    (void)context;
+    if (!stdio_usb_connected()) {
+        return 0; // keep buffering, frames are dropped once the buffers fill up
+    }
+    // only what fits in the CDC FIFO, so the write doesn't block
+    len = MIN(len, tud_cdc_write_available());
+    if (len != 0) {
+        stdio_usb.out_chars((const char *)data, (int)len);
+    }
+    return len;
+}
+
 static uint8_t get_volume() {
     // remap volume & volext into a continuous range between 0-30
     uint8_t volume = fm_get_volume(&radio);
@@ -127,16 +207,37 @@ static void set_volume(uint8_t volume) {
     }
 }
 
+static void reset_rds() {
+    rds_parser_reset(&rds_parser);
+    fm_af_follow_abort(&af_follow); // candidate history belongs to the old station
+    // AF method B lists are keyed to the tuned frequency
+    rds_parser_set_tuned_frequency_10khz(&rds_parser, fm_get_frequency_10khz(&radio));
+
+    // show the stored name before any RDS group arrives
+    const fm_station_record_t *record = fm_station_db_find(&station_db, fm_get_frequency_10khz(&radio));
+    if (record != NULL) {
+        fm_station_db_restore(record, &rds_parser);
+        printf("... known station, PI: %04X, PS: %.8s\n", record->pi, record->ps);
+    }
+}
+
 static void set_frequency(float frequency) {
     fm_set_frequency_blocking(&radio, frequency);
     print_station_info();
-    rds_parser_reset(&rds_parser);
+    reset_rds();
+}
+
+static void set_frequency_10khz(uint16_t frequency) {
+    fm_set_frequency_10khz_blocking(&radio, frequency);
+    print_station_info();
+    reset_rds();
 }
 
 static void seek(fm_seek_direction_t direction) {
     // The easiest way to seek would be with fm_seek_blocking(). The async version
     // frees up the CPU for other work. Here we just print the current frequency
-    // every 100ms until a new station has been found.
+    // every 100ms until a new station has been found. Volume keys still work, the
+    // change is written between seek polls.
 
     fm_seek_async(&radio, direction);
 
@@ -144,6 +245,12 @@ static void seek(fm_seek_direction_t direction) {
     fm_async_progress_t progress;
     do {
         sleep_ms(100);
+        int ch = getchar_timeout_us(0);
+        if (ch == '-' && 0 < get_volume()) {
+            set_volume(get_volume() - 1);
+        } else if (ch == '=' && get_volume() < 30) {
+            set_volume(get_volume() + 1);
+        }
         progress = fm_async_task_tick(&radio);
         printf("... %.2f MHz\n", fm_get_frequency(&radio));
     } while (!progress.done);
@@ -154,10 +261,69 @@ static void seek(fm_seek_direction_t direction) {
     } else {
         printf("... failed: %d\n", progress.result);
     }
-    rds_parser_reset(&rds_parser);
+    reset_rds();
+}
+
+static void ta_standby() {
+    // Muted, the core sleeps between RDS interrupts and only wakes up for good when a
+    // traffic announcement starts. Any key returns.
+    puts("TA standby...");
+    fm_ta_monitor_enter(&ta_monitor, rds_get_program_id(&rds_parser));
+    fm_ta_event_t event;
+    do {
+        event = fm_ta_monitor_wait(&ta_monitor, 1000);
+    } while (event != FM_TA_STARTED && getchar_timeout_us(0) == PICO_ERROR_TIMEOUT);
+    fm_ta_monitor_exit(&ta_monitor);
+    if (event == FM_TA_STARTED) {
+        puts("... traffic announcement");
+        fm_set_mute(&radio, false);
+    } else {
+        puts("... canceled");
+    }
+}
+
+static void scan() {
+    puts("Scanning...");
+    fm_scan_station_t stations[32];
+    fm_scan_config_t config = {.mode = FM_SCAN_SEEK, .min_rssi = 0, .dwell_ms = 500 /* wait for PI */};
+    size_t count = fm_scan_blocking(&radio, config, stations, count_of(stations));
+    for (size_t i = 0; i < count; i++) {
+        printf("... %u.%02u MHz, RSSI: %u, stereo: %u, PI: %04X\n",
+            stations[i].frequency / 100,
+            stations[i].frequency % 100,
+            stations[i].rssi,
+            stations[i].stereo,
+            stations[i].pi);
+    }
+    printf("... found %zu stations\n", count);
+    fm_station_db_update_from_scan(&station_db, stations, count);
+    fm_station_db_save(&station_db);
+    reset_rds();
+}
+
+static void update_af_follow() {
+    fm_af_follow_event_t event = fm_af_follow_tick(&af_follow, &rds_parser);
+    if (event == FM_AF_FOLLOW_SWITCHED) {
+        printf("AF switch, gap: %lu us\n", (unsigned long)af_follow.last_gap_us);
+        print_station_info();
+        rds_parser_set_tuned_frequency_10khz(&rds_parser, fm_get_frequency_10khz(&radio));
+    } else if (event == FM_AF_FOLLOW_RETURNED) {
+        printf("AF return, gap: %lu us\n", (unsigned long)af_follow.last_gap_us);
+    }
 }
 
 static void loop() {
+    if (SCANNER_RESET_PIN >= 0) {
+        fm_scanner_tick(&scanner); // independent of the primary radio
+    }
+    if (af_follow_enabled && fm_is_powered_up(&radio)) {
+        update_af_follow();
+        if (fm_af_follow_is_busy(&af_follow)) {
+            sleep_ms(2); // probing latency depends on the tick rate
+            return;
+        }
+    }
+
     int result = getchar_timeout_us(0);
     if (result != PICO_ERROR_TIMEOUT) {
         // handle command
@@ -173,27 +339,34 @@ static void loop() {
                     set_volume(get_volume() + 1);
                     printf("Set volume: %u\n", get_volume());
                 }
+            } else if ('0' < ch && ch <= '9' && fm_station_db_count(&station_db) != 0) {
+                size_t index = ch - '1';
+                if (index < fm_station_db_count(&station_db)) {
+                    set_frequency_10khz(fm_station_db_get(&station_db, index)->frequency);
+                }
             } else if ('0' < ch && ch <= '0' + count_of(STATION_PRESETS)) {
                 float frequency = STATION_PRESETS[ch - '1'];
                 set_frequency(frequency);
             } else if (ch == '{') {
-                fm_frequency_range_t range = fm_get_frequency_range(&radio);
-                float frequency = fm_get_frequency(&radio) - range.spacing;
+                fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(&radio);
+                uint16_t frequency = fm_get_frequency_10khz(&radio) - range.spacing;
                 if (frequency < range.bottom) {
                     frequency = range.top; // wrap to top
                 }
-                set_frequency(frequency);
+                set_frequency_10khz(frequency);
             } else if (ch == '}') {
-                fm_frequency_range_t range = fm_get_frequency_range(&radio);
-                float frequency = fm_get_frequency(&radio) + range.spacing;
+                fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(&radio);
+                uint16_t frequency = fm_get_frequency_10khz(&radio) + range.spacing;
                 if (range.top < frequency) {
                     frequency = range.bottom; // wrap to bottom
                 }
-                set_frequency(frequency);
+                set_frequency_10khz(frequency);
             } else if (ch == '[') {
                 seek(FM_SEEK_DOWN);
             } else if (ch == ']') {
                 seek(FM_SEEK_UP);
+            } else if (ch == 'a') {
+                scan();
             } else if (ch == 's') {
                 fm_seek_sensitivity_t next_sensitivity = (fm_get_seek_sensitivity(&radio) + 1) % 4;
                 fm_set_seek_sensitivity(&radio, next_sensitivity);
@@ -207,8 +380,31 @@ static void loop() {
             } else if (ch == 'm') {
                 fm_set_mono(&radio, !fm_get_mono(&radio));
                 printf("Set mono: %u\n", fm_get_mono(&radio));
+            } else if (ch == 'o') {
+                af_follow_enabled = !af_follow_enabled;
+                printf("Set AF following: %u\n", af_follow_enabled);
+            } else if (ch == 'v') {
+                if (fm_is_rds_supported(&radio)) {
+                    fm_set_rds_verbose(&radio, !fm_get_rds_verbose(&radio));
+                    printf("Set RDS verbose mode: %u\n", fm_get_rds_verbose(&radio));
+                }
+            } else if (ch == 'c') {
+                if (fm_is_rds_supported(&radio)) {
+                    rds_capture_enabled = !rds_capture_enabled;
+                    printf("Set RDS capture: %u\n", rds_capture_enabled);
+                    if (!rds_capture_enabled && rds_capture.dropped != 0) {
+                        printf("... %lu frames dropped\n", (unsigned long)rds_capture.dropped);
+                    }
+                    rds_capture_init(&rds_capture);
+                }
+            } else if (ch == 't') {
+                if (fm_is_rds_supported(&radio) && GPIO2_PIN >= 0) {
+                    ta_standby();
+                }
             } else if (ch == 'i') {
                 print_station_info();
+            } else if (ch == 'q') {
+                print_signal_quality();
             } else if (ch == 'r') {
                 if (fm_is_rds_supported(&radio)) {
                     print_rds_info();
@@ -216,6 +412,7 @@ static void loop() {
             } else if (ch == 'x') {
                 if (fm_is_powered_up(&radio)) {
                     puts("Power down");
+                    fm_station_db_save(&station_db);
                     fm_power_down(&radio);
                     rds_parser_reset(&rds_parser);
                 }
@@ -225,12 +422,17 @@ static void loop() {
         } else {
             puts("Power up");
             fm_power_up(&radio, FM_CONFIG);
+            reset_rds();
         }
     }
 
     if (fm_is_powered_up(&radio) && fm_is_rds_supported(&radio)) {
         update_rds(&radio);
     }
+    fm_signal_monitor_tick(&signal_monitor);
+    if (rds_capture_enabled) {
+        rds_capture_drain(&rds_capture, write_usb, NULL);
+    }
     sleep_ms(40);
 }
 
@@ -241,13 +443,31 @@ int main() {
     // Si470X supports up to 400kHz SCLK frequency
     i2c_init(i2c_default, 400 * 1000);
 
+    if (fm_station_db_init(&station_db)) {
+        printf("Loaded %zu stations\n", fm_station_db_count(&station_db));
+    }
+
     fm_init(&radio, i2c_default, RESET_PIN, SDIO_PIN, SCLK_PIN, true /* enable_pull_ups */);
+    if (GPIO2_PIN >= 0) {
+        fm_enable_interrupts(&radio, GPIO2_PIN);
+    }
     fm_power_up(&radio, FM_CONFIG);
     fm_set_frequency_blocking(&radio, DEFAULT_FREQUENCY);
     fm_set_volume(&radio, 15, true /* volext */);
     fm_set_mute(&radio, false);
 
-    rds_parser_reset(&rds_parser);
+    fm_af_follow_init(&af_follow, &radio, fm_af_follow_default_config());
+    fm_signal_monitor_init(&signal_monitor, &radio, 200);
+    fm_ta_monitor_init(&ta_monitor, &radio);
+    if (SCANNER_RESET_PIN >= 0) {
+        i2c_init(i2c1, 400 * 1000);
+        fm_init(&scanner_radio, i2c1, SCANNER_RESET_PIN, SCANNER_SDIO_PIN, SCANNER_SCLK_PIN, true /* enable_pull_ups */);
+        fm_power_up(&scanner_radio, FM_CONFIG);
+        fm_scanner_init(&scanner, &scanner_radio, &station_db, fm_scanner_default_config());
+        fm_scanner_start(&scanner);
+    }
+    reset_rds();
+    rds_group_queue_init(&rds_queue);
     do {
         loop();
     } while (true);
@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_multi.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+static const uint RDS_POLL_INTERVAL_MS = 40;
+
+static bool fm_multi_is_bus_taken(fm_multi_t *multi, size_t index) {
+    // another radio on the same I2C instance has a transfer pending
+    i2c_inst_t *i2c_inst = multi->slots[index].radio->i2c_inst;
+    for (size_t i = 0; i < multi->count; i++) {
+        si470x_t *other = multi->slots[i].radio;
+        if (i != index && other->i2c_inst == i2c_inst && fm_is_bus_busy(other)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void fm_multi_tick_radio(fm_multi_t *multi, size_t index, uint64_t now) {
+    fm_multi_slot_t *slot = &multi->slots[index];
+    si470x_t *radio = slot->radio;
+
+    if (radio->async.task == NULL) {
+        if (multi->rds_callback == NULL || !fm_is_powered_up(radio) || !fm_is_rds_supported(radio)) {
+            return;
+        }
+        if (now < slot->next_rds_time) {
+            return;
+        }
+        // with interrupts, the read only checks a flag until a group is signaled
+        uint interval_ms = radio->irq_enabled ? 0 : RDS_POLL_INTERVAL_MS;
+        slot->next_rds_time = now + interval_ms * 1000;
+        fm_read_rds_group_async(radio, slot->rds_blocks);
+        slot->rds_reading = true;
+    }
+
+    fm_async_progress_t progress = fm_async_task_tick(radio);
+    if (progress.done && slot->rds_reading) {
+        slot->rds_reading = false;
+        if (progress.result == 1) {
+            uint8_t bler[4];
+            fm_get_rds_block_errors(radio, bler);
+            multi->rds_callback(multi, index, slot->rds_blocks, bler, multi->user_data);
+        }
+    }
+}
+
+//
+// public interface
+//
+
+void fm_multi_init(fm_multi_t *multi, fm_multi_rds_callback_t rds_callback, void *user_data) {
+    memset(multi, 0, sizeof(fm_multi_t));
+
+    multi->rds_callback = rds_callback;
+    multi->user_data = user_data;
+}
+
+size_t fm_multi_add(fm_multi_t *multi, si470x_t *radio) {
+    assert(multi->count < FM_MULTI_MAX_RADIOS);
+
+    size_t index = multi->count++;
+    multi->slots[index] = (fm_multi_slot_t){.radio = radio};
+    return index;
+}
+
+void fm_multi_tick(fm_multi_t *multi) {
+    if (multi->count == 0) {
+        return;
+    }
+    uint64_t now = time_us_64();
+    for (size_t i = 0; i < multi->count; i++) {
+        size_t index = (multi->next_index + i) % multi->count;
+        if (fm_multi_is_bus_taken(multi, index)) {
+            continue; // retry on next tick
+        }
+        fm_multi_tick_radio(multi, index, now);
+    }
+    multi->next_index = (multi->next_index + 1) % multi->count;
+}
+
+void fm_multi_yield(fm_multi_t *multi, size_t index) {
+    assert(index < multi->count);
+
+    fm_multi_slot_t *slot = &multi->slots[index];
+    if (slot->rds_reading) {
+        fm_async_task_cancel(slot->radio);
+        slot->rds_reading = false;
+    }
+}
@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_MULTI_H_
+#define _FM_MULTI_H_
+
+#include <fm_si470x.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_multi.h
+ *
+ * \brief Scheduler for several radios.
+ *
+ * Services an array of radios from a single loop, interleaving their async tasks so that
+ * tuning and RDS reads on different chips overlap. Radios may sit on different I2C instances,
+ * or share one through a mux (see fm_set_bus_select()). In the latter case the scheduler
+ * makes sure only one radio uses the bus at a time.
+ *
+ * When a radio has no task of its own, the scheduler reads RDS groups from it and passes them
+ * to a callback. For best throughput, enable DMA on each radio with fm_enable_dma(), so
+ * transfers on different I2C instances run in parallel.
+ */
+
+#ifndef FM_MULTI_MAX_RADIOS
+#define FM_MULTI_MAX_RADIOS 4
+#endif
+
+struct fm_multi_t;
+
+/**
+ * \brief Function called for each received RDS group.
+ *
+ * @param multi Scheduler.
+ * @param index Radio index, as returned by fm_multi_add().
+ * @param blocks RDS blocks A-D.
+ * @param bler Error levels for blocks A-D, see fm_get_rds_block_errors().
+ * @param user_data User data.
+ */
+typedef void (*fm_multi_rds_callback_t)(struct fm_multi_t *multi, size_t index, const uint16_t *blocks, const uint8_t *bler, void *user_data);
+
+// private
+typedef struct fm_multi_slot_t
+{
+    si470x_t *radio;
+    uint16_t rds_blocks[4];
+    bool rds_reading; // radio is running the scheduler's RDS read task
+    uint64_t next_rds_time;
+} fm_multi_slot_t;
+
+/**
+ * \brief Multi-radio scheduler.
+ */
+typedef struct fm_multi_t
+{
+    fm_multi_slot_t slots[FM_MULTI_MAX_RADIOS];
+    size_t count;
+    size_t next_index; // round-robin start, so radios sharing a bus take turns
+    fm_multi_rds_callback_t rds_callback;
+    void *user_data;
+} fm_multi_t;
+
+/**
+ * \brief Initialize the scheduler.
+ *
+ * @param multi Scheduler.
+ * @param rds_callback Function to call for received RDS groups, or NULL to skip RDS reads.
+ * @param user_data User data for rds_callback.
+ */
+void fm_multi_init(fm_multi_t *multi, fm_multi_rds_callback_t rds_callback, void *user_data);
+
+/**
+ * \brief Add a radio to the scheduler.
+ *
+ * The radio must already be initialized with fm_init(). It may be powered up later.
+ *
+ * @param multi Scheduler.
+ * @param radio Radio handle.
+ * @return Radio index.
+ */
+size_t fm_multi_add(fm_multi_t *multi, si470x_t *radio);
+
+/**
+ * \brief Tick async tasks and read RDS groups on all radios.
+ *
+ * Should be called often, e.g. every 5ms. Radios whose I2C instance is in use by another
+ * radio are skipped until the next call.
+ *
+ * @param multi Scheduler.
+ */
+void fm_multi_tick(fm_multi_t *multi);
+
+/**
+ * \brief Stop the scheduler's RDS read on a radio, so an async task may be started.
+ *
+ * Must be called before starting a task such as fm_set_frequency_async() on a scheduled radio.
+ * The task is then ticked by fm_multi_tick(). Use fm_async_task_set_callback() to get notified
+ * on completion. RDS reads resume after the task is done.
+ *
+ * @param multi Scheduler.
+ * @param index Radio index.
+ */
+void fm_multi_yield(fm_multi_t *multi, size_t index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_MULTI_H_
@@ -0,0 +1,115 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "fm_pio_i2c.pio.h"
+#include <fm_pio_i2c.h>
+#include <pico/stdlib.h>
+
+//
+// bus conditions
+//
+
+static void fm_pio_i2c_exec(fm_pio_i2c_t *bus, uint instr) {
+    // the state machine is stalled on pull while idle, run a single instruction and let the lines settle
+    pio_sm_exec(bus->pio, bus->sm, instr);
+    busy_wait_us_32(bus->half_period_us);
+}
+
+static void fm_pio_i2c_start(fm_pio_i2c_t *bus) {
+    // SDA falls while SCL is high, then SCL low for the first bit
+    fm_pio_i2c_exec(bus, pio_encode_set(pio_pindirs, 1));
+    fm_pio_i2c_exec(bus, pio_encode_nop() | pio_encode_sideset_opt(1, 1));
+}
+
+static void fm_pio_i2c_stop(fm_pio_i2c_t *bus) {
+    // SCL is low after the last byte, SDA rises while SCL is high
+    fm_pio_i2c_exec(bus, pio_encode_set(pio_pindirs, 1));
+    fm_pio_i2c_exec(bus, pio_encode_nop() | pio_encode_sideset_opt(1, 0));
+    fm_pio_i2c_exec(bus, pio_encode_set(pio_pindirs, 0));
+}
+
+static uint fm_pio_i2c_transfer_byte(fm_pio_i2c_t *bus, uint bits) {
+    // bits: 8 data bits followed by the ACK bit, as line levels
+    uint32_t pindirs = ~bits & 0x1FF;
+    pio_sm_put_blocking(bus->pio, bus->sm, pindirs << 23);
+    return pio_sm_get_blocking(bus->pio, bus->sm) & 0x1FF;
+}
+
+static bool fm_pio_i2c_write_byte(fm_pio_i2c_t *bus, uint8_t value) {
+    uint sampled = fm_pio_i2c_transfer_byte(bus, (value << 1) | 1 /* released for ACK */);
+    return (sampled & 1) == 0; // acknowledged
+}
+
+static uint8_t fm_pio_i2c_read_byte(fm_pio_i2c_t *bus, bool ack) {
+    uint sampled = fm_pio_i2c_transfer_byte(bus, (0xFF << 1) | (ack ? 0 : 1));
+    return (uint8_t)(sampled >> 1);
+}
+
+//
+// transport
+//
+
+static void fm_pio_i2c_init_pins(void *context, uint8_t sdio_pin, uint8_t sclk_pin, bool enable_pull_ups) {
+    fm_pio_i2c_t *bus = (fm_pio_i2c_t *)context;
+    fm_pio_i2c_program_init(bus->pio, bus->sm, bus->offset, sdio_pin, sclk_pin, bus->baudrate);
+    if (enable_pull_ups) {
+        gpio_pull_up(sdio_pin);
+        gpio_pull_up(sclk_pin);
+    }
+}
+
+static bool fm_pio_i2c_read(void *context, uint8_t addr, uint8_t *dst, size_t len) {
+    fm_pio_i2c_t *bus = (fm_pio_i2c_t *)context;
+    fm_pio_i2c_start(bus);
+    bool success = fm_pio_i2c_write_byte(bus, (addr << 1) | 1 /* read */);
+    if (success) {
+        for (size_t i = 0; i < len; i++) {
+            bool last = (i + 1 == len);
+            dst[i] = fm_pio_i2c_read_byte(bus, !last);
+        }
+    }
+    fm_pio_i2c_stop(bus);
+    return success;
+}
+
+static bool fm_pio_i2c_write(void *context, uint8_t addr, const uint8_t *src, size_t len) {
+    fm_pio_i2c_t *bus = (fm_pio_i2c_t *)context;
+    fm_pio_i2c_start(bus);
+    bool success = fm_pio_i2c_write_byte(bus, addr << 1 /* write */);
+    for (size_t i = 0; success && i < len; i++) {
+        success = fm_pio_i2c_write_byte(bus, src[i]);
+    }
+    fm_pio_i2c_stop(bus);
+    return success;
+}
+
+//
+// public interface
+//
+
+const fm_transport_t fm_pio_i2c_transport = {
+    .init_pins = fm_pio_i2c_init_pins,
+    .read = fm_pio_i2c_read,
+    .write = fm_pio_i2c_write,
+};
+
+bool fm_pio_i2c_init(fm_pio_i2c_t *bus, PIO pio, uint baudrate) {
+    assert(0 < baudrate && baudrate <= 400 * 1000);
+
+    if (!pio_can_add_program(pio, &fm_pio_i2c_program)) {
+        return false;
+    }
+    int sm = pio_claim_unused_sm(pio, false);
+    if (sm < 0) {
+        return false;
+    }
+    bus->pio = pio;
+    bus->sm = (uint)sm;
+    bus->offset = pio_add_program(pio, &fm_pio_i2c_program);
+    bus->baudrate = baudrate;
+    bus->half_period_us = (500 * 1000 + baudrate - 1) / baudrate;
+    return true;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_PIO_I2C_H_
+#define _FM_PIO_I2C_H_
+
+#include <fm_si470x.h>
+#include <hardware/pio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_pio_i2c.h
+ *
+ * \brief PIO transport for the Si470x bus.
+ *
+ * Runs the radio's I2C bus on a PIO state machine, leaving the hardware I2C controllers
+ * free for other devices. Any two GPIO pins may be used for SDIO and SCLK.
+ *
+ * Usage:
+ *
+ *     fm_pio_i2c_init(&bus, pio0, 400 * 1000);
+ *     fm_init(&radio, NULL, RESET_PIN, SDIO_PIN, SCLK_PIN, true);
+ *     fm_set_transport(&radio, &fm_pio_i2c_transport, &bus);
+ *     fm_power_up(&radio, fm_config_europe());
+ */
+
+/**
+ * \brief PIO transport state.
+ */
+typedef struct fm_pio_i2c_t
+{
+    PIO pio;
+    uint sm;
+    uint offset;
+    uint baudrate;
+    uint half_period_us;
+} fm_pio_i2c_t;
+
+/**
+ * \brief Transport functions for fm_set_transport(), with a fm_pio_i2c_t context.
+ */
+extern const fm_transport_t fm_pio_i2c_transport;
+
+/**
+ * \brief Load the PIO program and claim a state machine.
+ *
+ * Pins are configured later, when the radio powers up.
+ *
+ * @param bus Transport state.
+ * @param pio PIO instance.
+ * @param baudrate SCLK frequency in Hz, up to 400kHz.
+ * @return true Initialized.
+ * @return false No free instruction memory or state machine.
+ */
+bool fm_pio_i2c_init(fm_pio_i2c_t *bus, PIO pio, uint baudrate);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_PIO_I2C_H_
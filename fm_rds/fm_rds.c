@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_rds.h>
+#include <pico/stdlib.h>
+
+//
+// public interface
+//
+
+bool fm_read_and_parse_rds(si470x_t *radio, rds_parser_t *parser, uint32_t *changes) {
+    rds_group_t group;
+    uint8_t bler[4];
+    if (!fm_read_rds_group_with_errors(radio, group.blocks, bler)) {
+        return false;
+    }
+    uint32_t group_changes = rds_parser_update_with_errors(parser, &group, bler);
+    if (changes != NULL) {
+        *changes = group_changes;
+    }
+    return true;
+}
+
+bool fm_read_rds_into_queue(si470x_t *radio, rds_group_queue_t *queue) {
+    if (rds_group_queue_get_count(queue) == RDS_GROUP_QUEUE_CAPACITY) {
+        // full, read anyway so the group is counted as dropped
+        rds_group_entry_t entry;
+        if (fm_read_rds_group_with_errors(radio, entry.group.blocks, entry.bler)) {
+            rds_group_queue_push(queue, &entry);
+        }
+        return false;
+    }
+    rds_group_entry_t *slot = rds_group_queue_begin_push(queue);
+    if (!fm_read_rds_group_with_errors(radio, slot->group.blocks, slot->bler)) {
+        return false; // slot is reused by the next push
+    }
+    slot->timestamp_us = time_us_32();
+    rds_group_queue_commit_push(queue);
+    return true;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_RDS_H_
+#define _FM_RDS_H_
+
+#include <fm_si470x.h>
+#include <rds_group_queue.h>
+#include <rds_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_rds.h
+ *
+ * \brief Glue between the Si470x driver and the RDS parser.
+ *
+ * Reads RDS groups with fm_read_rds_group_with_errors() straight into their destination,
+ * either the parser or a queue slot, without intermediate buffers.
+ */
+
+/**
+ * \brief Read an RDS group and pass it to the parser.
+ *
+ * Corrupted blocks are handled as in rds_parser_update_with_errors().
+ *
+ * @param radio Radio handle.
+ * @param parser RDS parser.
+ * @param changes Output bitmask of rds_change_t flags, may be NULL.
+ * @return true A group was read and parsed.
+ * @return false RDS data not yet ready.
+ */
+bool fm_read_and_parse_rds(si470x_t *radio, rds_parser_t *parser, uint32_t *changes);
+
+/**
+ * \brief Read an RDS group into the next queue slot.
+ *
+ * Producer side of rds_group_queue_t, e.g. from a GPIO IRQ or core1. The group is read
+ * directly into the slot, along with its error levels and timestamp.
+ *
+ * @param radio Radio handle.
+ * @param queue RDS group queue.
+ * @return true A group was queued.
+ * @return false RDS data not yet ready, or the queue is full and the group was dropped.
+ */
+bool fm_read_rds_into_queue(si470x_t *radio, rds_group_queue_t *queue);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_RDS_H_
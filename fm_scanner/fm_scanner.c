@@ -0,0 +1,200 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_scanner.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+static const uint RDS_POLL_INTERVAL_MS = 40;
+
+//
+// station list
+//
+
+static bool fm_scanner_was_found(const fm_scanner_t *scanner, uint16_t frequency) {
+    for (size_t i = 0; i < scanner->station_count; i++) {
+        if (scanner->stations[i].frequency == frequency) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool fm_scanner_was_missing(const fm_scanner_t *scanner, uint16_t frequency) {
+    for (size_t i = 0; i < scanner->missing_count; i++) {
+        if (scanner->missing[i] == frequency) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static bool fm_scanner_remove_missing(fm_scanner_t *scanner) {
+    // stations already missing from the previous pass are removed, the others get a second chance
+    fm_station_db_t *db = scanner->db;
+    uint16_t missing[FM_STATION_DB_CAPACITY];
+    size_t missing_count = 0;
+    bool changed = false;
+    for (size_t i = 0; i < fm_station_db_count(db);) {
+        uint16_t frequency = fm_station_db_get(db, i)->frequency;
+        if (fm_scanner_was_found(scanner, frequency)) {
+            i++;
+        } else if (fm_scanner_was_missing(scanner, frequency)) {
+            fm_station_db_remove(db, frequency);
+            changed = true;
+        } else {
+            missing[missing_count++] = frequency;
+            i++;
+        }
+    }
+    memcpy(scanner->missing, missing, missing_count * sizeof(uint16_t));
+    scanner->missing_count = missing_count;
+    return changed;
+}
+
+//
+// steps
+//
+
+static void fm_scanner_start_pass(fm_scanner_t *scanner) {
+    fm_scan_config_t scan_config = scanner->config.scan;
+    scan_config.dwell_ms = 0; // RDS is collected afterwards, with a longer dwell
+    fm_scan_async(scanner->radio, scan_config, scanner->stations, FM_SCANNER_MAX_STATIONS);
+    scanner->state = FM_SCANNER_SCANNING;
+}
+
+static bool fm_scanner_next_station(fm_scanner_t *scanner) {
+    // tune the next station found, or finish the pass
+    if (scanner->station_index < scanner->station_count) {
+        fm_set_frequency_10khz_async(scanner->radio, scanner->stations[scanner->station_index].frequency);
+        scanner->state = FM_SCANNER_TUNING;
+        return false;
+    }
+    bool changed = false;
+    if (scanner->config.remove_missing && scanner->complete) {
+        changed = fm_scanner_remove_missing(scanner);
+    }
+    scanner->pass_count++;
+    scanner->next_time = time_us_64() + scanner->config.pass_interval_ms * 1000ull;
+    scanner->state = FM_SCANNER_WAITING;
+    return changed;
+}
+
+static void fm_scanner_start_collecting(fm_scanner_t *scanner) {
+    uint64_t now = time_us_64();
+    rds_parser_reset(&scanner->parser);
+    rds_parser_set_tuned_frequency_10khz(&scanner->parser, fm_get_frequency_10khz(scanner->radio));
+    scanner->rds_changes = 0;
+    scanner->next_time = now;
+    scanner->pi_end_time = now + scanner->config.pi_timeout_ms * 1000;
+    scanner->end_time = now + scanner->config.dwell_ms * 1000;
+    scanner->state = FM_SCANNER_COLLECTING;
+}
+
+static bool fm_scanner_collect(fm_scanner_t *scanner, uint64_t now) {
+    // returns true once the station is done
+    si470x_t *radio = scanner->radio;
+    if (scanner->next_time <= now) {
+        // with interrupts, the read only checks a flag until a group is signaled
+        scanner->next_time = now + (radio->irq_enabled ? 0 : RDS_POLL_INTERVAL_MS * 1000);
+        union
+        {
+            uint16_t group_data[4];
+            rds_group_t group;
+        } rds;
+        uint8_t bler[4];
+        if (fm_read_rds_group_with_errors(radio, rds.group_data, bler)) {
+            scanner->rds_changes |= rds_parser_update_with_errors(&scanner->parser, &rds.group, bler);
+        }
+    }
+    uint32_t wanted = RDS_CHANGE_PS;
+#if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+    wanted |= RDS_CHANGE_AF;
+#endif
+    if ((scanner->rds_changes & wanted) == wanted || scanner->end_time <= now) {
+        return true;
+    }
+    return rds_get_program_id(&scanner->parser) == 0 && scanner->pi_end_time <= now; // no RDS
+}
+
+//
+// public interface
+//
+
+void fm_scanner_init(fm_scanner_t *scanner, si470x_t *radio, fm_station_db_t *db, fm_scanner_config_t config) {
+    memset(scanner, 0, sizeof(fm_scanner_t));
+
+    scanner->radio = radio;
+    scanner->db = db;
+    scanner->config = config;
+    scanner->state = FM_SCANNER_STOPPED;
+    rds_parser_reset(&scanner->parser);
+}
+
+void fm_scanner_start(fm_scanner_t *scanner) {
+    si470x_t *radio = scanner->radio;
+    assert(fm_is_powered_up(radio));
+    assert(fm_is_rds_supported(radio));
+
+    if (scanner->state != FM_SCANNER_STOPPED) {
+        return;
+    }
+    fm_set_mute(radio, true);
+    scanner->next_time = time_us_64();
+    scanner->state = FM_SCANNER_WAITING;
+}
+
+void fm_scanner_stop(fm_scanner_t *scanner) {
+    si470x_t *radio = scanner->radio;
+    if (scanner->state == FM_SCANNER_SCANNING || scanner->state == FM_SCANNER_TUNING) {
+        fm_async_task_cancel(radio);
+    }
+    scanner->state = FM_SCANNER_STOPPED;
+}
+
+bool fm_scanner_tick(fm_scanner_t *scanner) {
+    si470x_t *radio = scanner->radio;
+    uint64_t now = time_us_64();
+    switch (scanner->state) {
+    case FM_SCANNER_WAITING:
+        if (scanner->next_time <= now && fm_is_powered_up(radio)) {
+            fm_scanner_start_pass(scanner);
+        }
+        return false;
+
+    case FM_SCANNER_SCANNING: {
+        fm_async_progress_t progress = fm_async_task_tick(radio);
+        if (!progress.done) {
+            return false;
+        }
+        // a full station list may not reach the top of the band
+        scanner->station_count = MAX(progress.result, 0);
+        scanner->complete = (0 <= progress.result && scanner->station_count < FM_SCANNER_MAX_STATIONS);
+        scanner->station_index = 0;
+        return fm_scanner_next_station(scanner);
+    }
+
+    case FM_SCANNER_TUNING: {
+        fm_async_progress_t progress = fm_async_task_tick(radio);
+        if (progress.done) {
+            fm_scanner_start_collecting(scanner);
+        }
+        return false;
+    }
+
+    case FM_SCANNER_COLLECTING:
+        if (!fm_scanner_collect(scanner, now)) {
+            return false;
+        }
+        fm_station_db_update(scanner->db, fm_get_frequency_10khz(radio), fm_get_rssi(radio), &scanner->parser);
+        scanner->station_index++;
+        fm_scanner_next_station(scanner);
+        return true;
+
+    default: // FM_SCANNER_STOPPED
+        return false;
+    }
+}
@@ -0,0 +1,164 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_SCANNER_H_
+#define _FM_SCANNER_H_
+
+#include <fm_si470x.h>
+#include <fm_station_db.h>
+#include <rds_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_scanner.h
+ *
+ * \brief Background band scanner on a second radio.
+ *
+ * Keeps a station database up to date without touching the radio that is playing. A
+ * secondary Si4703, muted, repeatedly scans the band, then tunes each station found and
+ * collects its PI, PS name and AF list into the database. The primary radio can then look
+ * up names and alternative frequencies of any station (see fm_station_db_restore()), and
+ * never has to seek or mute to refresh them.
+ *
+ * Stations missed by two complete passes in a row are removed, so a single fade doesn't
+ * drop them. The database is only updated in RAM, saving it to flash is left to the caller.
+ *
+ * The scanner runs its own async tasks on the secondary radio, which must not be used
+ * otherwise while scanning. Radios on separate I2C instances work best; on a shared bus,
+ * see fm_set_bus_select().
+ *
+ * Usage:
+ *
+ *     fm_init(&scan_radio, i2c1, SCAN_RESET_PIN, SCAN_SDIO_PIN, SCAN_SCLK_PIN, true);
+ *     fm_power_up(&scan_radio, fm_config_europe());
+ *     fm_scanner_init(&scanner, &scan_radio, &station_db, fm_scanner_default_config());
+ *     fm_scanner_start(&scanner);
+ *     while (true) {
+ *         if (fm_scanner_tick(&scanner)) {
+ *             // station list changed
+ *         }
+ *         ...
+ *     }
+ */
+
+#ifndef FM_SCANNER_MAX_STATIONS
+#define FM_SCANNER_MAX_STATIONS 32
+#endif
+
+/**
+ * \brief Scanner settings.
+ */
+typedef struct fm_scanner_config_t
+{
+    fm_scan_config_t scan; /**< Band scan settings. dwell_ms is ignored, RDS is collected per station. */
+    uint16_t pi_timeout_ms; /**< Move on if no RDS PI arrives in this time. */
+    uint16_t dwell_ms; /**< Maximum time collecting RDS on a station. */
+    uint32_t pass_interval_ms; /**< Pause between passes over the band. */
+    bool remove_missing; /**< Remove stations no longer found. */
+} fm_scanner_config_t;
+
+/**
+ * \brief Get the default scanner settings.
+ */
+static inline fm_scanner_config_t fm_scanner_default_config() {
+    return (fm_scanner_config_t){
+        .scan = {
+            .mode = FM_SCAN_SEEK,
+            .min_rssi = 20,
+        },
+        .pi_timeout_ms = 500,
+        .dwell_ms = 5000, // AF lists take a few PS cycles
+        .pass_interval_ms = 60 * 1000,
+        .remove_missing = true,
+    };
+}
+
+// private
+typedef enum fm_scanner_state_t
+{
+    FM_SCANNER_STOPPED,
+    FM_SCANNER_WAITING,
+    FM_SCANNER_SCANNING,
+    FM_SCANNER_TUNING,
+    FM_SCANNER_COLLECTING,
+} fm_scanner_state_t;
+
+/**
+ * \brief Background scanner.
+ */
+typedef struct fm_scanner_t
+{
+    si470x_t *radio;
+    fm_station_db_t *db;
+    fm_scanner_config_t config;
+    fm_scanner_state_t state;
+    uint64_t next_time; // next pass or RDS poll
+    uint64_t pi_end_time;
+    uint64_t end_time;
+    fm_scan_station_t stations[FM_SCANNER_MAX_STATIONS]; // found by the current pass
+    size_t station_count;
+    size_t station_index; // station collecting RDS
+    bool complete; // current pass covered the whole band
+    uint32_t rds_changes; // accumulated for the current station
+    rds_parser_t parser;
+    uint16_t missing[FM_STATION_DB_CAPACITY]; // stored stations not found by the last pass
+    size_t missing_count;
+    uint32_t pass_count; /**< Passes completed. */
+} fm_scanner_t;
+
+/**
+ * \brief Initialize the scanner.
+ *
+ * @param scanner Scanner.
+ * @param radio Secondary radio. Must be initialized with fm_init() and support RDS.
+ * @param db Station database to update.
+ * @param config Settings, e.g. fm_scanner_default_config().
+ */
+void fm_scanner_init(fm_scanner_t *scanner, si470x_t *radio, fm_station_db_t *db, fm_scanner_config_t config);
+
+/**
+ * \brief Start scanning, beginning with a pass right away.
+ *
+ * The radio must be powered up. Its audio is muted. Stop the scanner before powering the
+ * radio down.
+ *
+ * @param scanner Scanner.
+ */
+void fm_scanner_start(fm_scanner_t *scanner);
+
+/**
+ * \brief Stop scanning, canceling any task on the radio.
+ *
+ * @param scanner Scanner.
+ */
+void fm_scanner_stop(fm_scanner_t *scanner);
+
+/**
+ * \brief Advance the scan.
+ *
+ * Call often, e.g. every 5-40ms. Ticks the radio's async tasks and polls RDS groups.
+ *
+ * @param scanner Scanner.
+ * @return true A station was added, updated or removed.
+ */
+bool fm_scanner_tick(fm_scanner_t *scanner);
+
+/**
+ * \brief Check whether the scanner is running.
+ *
+ * @param scanner Scanner.
+ */
+static inline bool fm_scanner_is_running(const fm_scanner_t *scanner) {
+    return scanner->state != FM_SCANNER_STOPPED;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_SCANNER_H_
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_service.h>
+#include <pico/multicore.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+static const uint SERVICE_POLL_INTERVAL_MS = 5;
+static const uint RDS_POLL_INTERVAL_MS = 40;
+
+//
+// core1
+//
+
+static void fm_service_post(fm_service_t *service, const fm_event_t *event) {
+    if (!queue_try_add(&service->events, event)) {
+        service->dropped_events++;
+    }
+}
+
+static void fm_service_reset_rds(fm_service_t *service) {
+    critical_section_enter_blocking(&service->rds_lock);
+    rds_parser_reset(&service->rds_parser);
+    rds_parser_set_tuned_frequency_10khz(&service->rds_parser, fm_get_frequency_10khz(service->radio));
+    critical_section_exit(&service->rds_lock);
+}
+
+// the parser needs the frequency actually reached to check AF lists, known only once tuning completes
+static void fm_service_tune_complete(fm_service_t *service, int result) {
+    critical_section_enter_blocking(&service->rds_lock);
+    rds_parser_set_tuned_frequency_10khz(&service->rds_parser, fm_get_frequency_10khz(service->radio));
+    critical_section_exit(&service->rds_lock);
+    fm_service_post(service, &(fm_event_t){
+        .type = FM_EVENT_TUNE_COMPLETE,
+        .frequency = fm_get_frequency(service->radio),
+        .result = result,
+    });
+}
+
+static void fm_service_handle_command(fm_service_t *service, const fm_command_t *command) {
+    si470x_t *radio = service->radio;
+
+    if (command->type == FM_COMMAND_POWER_UP) {
+        if (!fm_is_powered_up(radio)) {
+            fm_power_up(radio, command->config);
+            fm_service_reset_rds(service);
+            fm_service_post(service, &(fm_event_t){.type = FM_EVENT_POWERED_UP});
+        }
+        return;
+    }
+    if (!fm_is_powered_up(radio)) {
+        return; // ignored
+    }
+
+    bool task_running = (radio->async.task != NULL);
+    switch (command->type) {
+    case FM_COMMAND_POWER_DOWN:
+        fm_power_down(radio);
+        fm_service_reset_rds(service);
+        fm_service_post(service, &(fm_event_t){.type = FM_EVENT_POWERED_DOWN});
+        return;
+    case FM_COMMAND_SET_FREQUENCY:
+    case FM_COMMAND_SEEK:
+    case FM_COMMAND_CANCEL:
+        if (task_running) {
+            fm_async_task_cancel(radio);
+            fm_service_tune_complete(service, -1);
+        }
+        if (command->type == FM_COMMAND_SET_FREQUENCY) {
+            fm_set_frequency_async(radio, command->frequency);
+        } else if (command->type == FM_COMMAND_SEEK) {
+            fm_seek_async(radio, command->direction);
+        }
+        critical_section_enter_blocking(&service->rds_lock);
+        rds_parser_reset(&service->rds_parser);
+        critical_section_exit(&service->rds_lock);
+        return;
+    default:
+        break;
+    }
+
+    // setters may be called during a seek, the changes are written between its polls
+    switch (command->type) {
+    case FM_COMMAND_SET_SEEK_SENSITIVITY:
+        fm_set_seek_sensitivity(radio, command->seek_sensitivity);
+        break;
+    case FM_COMMAND_SET_VOLUME:
+        fm_set_volume(radio, command->volume, command->volext);
+        break;
+    case FM_COMMAND_SET_MUTE:
+        fm_set_mute(radio, command->flag);
+        break;
+    case FM_COMMAND_SET_SOFTMUTE:
+        fm_set_softmute(radio, command->flag);
+        break;
+    case FM_COMMAND_SET_MONO:
+        fm_set_mono(radio, command->flag);
+        break;
+    case FM_COMMAND_SET_SIGNAL_INTERVAL:
+        service->signal_interval_ms = command->interval_ms;
+        service->next_signal_time = time_us_64();
+        break;
+    default:
+        break;
+    }
+}
+
+static void fm_service_update_rds(fm_service_t *service) {
+    si470x_t *radio = service->radio;
+
+    union
+    {
+        uint16_t group_data[4];
+        rds_group_t group;
+    } rds;
+    uint8_t bler[4];
+    if (!fm_read_rds_group_with_errors(radio, rds.group_data, bler)) {
+        return;
+    }
+    if (service->rds_group_events) {
+        fm_service_post(service, &(fm_event_t){.type = FM_EVENT_RDS_GROUP, .rds_group = rds.group});
+    }
+
+    rds_parser_t *parser = &service->rds_parser;
+    critical_section_enter_blocking(&service->rds_lock);
+    uint32_t changes = rds_parser_update_with_errors(parser, &rds.group, bler);
+    critical_section_exit(&service->rds_lock);
+
+    if (changes & RDS_CHANGE_PS) {
+        fm_event_t event = {.type = FM_EVENT_PS_CHANGED};
+        memcpy(event.ps_str, parser->ps_str, sizeof(event.ps_str));
+        fm_service_post(service, &event);
+    }
+    if (changes & RDS_CHANGE_RT) {
+        fm_service_post(service, &(fm_event_t){.type = FM_EVENT_RT_CHANGED});
+    }
+}
+
+static void fm_service_update(fm_service_t *service) {
+    si470x_t *radio = service->radio;
+
+    fm_command_t command;
+    while (queue_try_remove(&service->commands, &command)) {
+        fm_service_handle_command(service, &command);
+    }
+    if (!fm_is_powered_up(radio)) {
+        return;
+    }
+
+    if (radio->async.task != NULL) {
+        fm_async_progress_t progress = fm_async_task_tick(radio);
+        if (progress.done) {
+            fm_service_tune_complete(service, progress.result);
+        }
+        return; // no signal / RDS while tuning
+    }
+
+    uint64_t now = time_us_64();
+    if (service->signal_interval_ms != 0 && service->next_signal_time <= now) {
+        service->next_signal_time = now + service->signal_interval_ms * 1000;
+        fm_status_t status;
+        fm_get_status(radio, &status);
+        fm_service_post(service, &(fm_event_t){
+            .type = FM_EVENT_SIGNAL,
+            .rssi = status.rssi,
+            .stereo = status.stereo,
+        });
+    }
+
+    if (fm_is_rds_supported(radio)) {
+        // with interrupts, reads happen only when signaled, so checking often is cheap
+        if (radio->irq_enabled || service->next_rds_time <= now) {
+            service->next_rds_time = now + RDS_POLL_INTERVAL_MS * 1000;
+            fm_service_update_rds(service);
+        }
+    }
+}
+
+static void fm_service_core1_entry() {
+    fm_service_t *service = (fm_service_t *)(uintptr_t)multicore_fifo_pop_blocking();
+    do {
+        fm_service_update(service);
+        sleep_ms(SERVICE_POLL_INTERVAL_MS);
+    } while (true);
+}
+
+//
+// public interface
+//
+
+void fm_service_init(fm_service_t *service, si470x_t *radio, bool rds_group_events) {
+    memset(service, 0, sizeof(fm_service_t));
+
+    service->radio = radio;
+    service->rds_group_events = rds_group_events;
+    queue_init(&service->commands, sizeof(fm_command_t), FM_SERVICE_COMMAND_QUEUE_SIZE);
+    queue_init(&service->events, sizeof(fm_event_t), FM_SERVICE_EVENT_QUEUE_SIZE);
+    critical_section_init(&service->rds_lock);
+    rds_parser_reset(&service->rds_parser);
+}
+
+void fm_service_launch(fm_service_t *service) {
+    multicore_launch_core1(fm_service_core1_entry);
+    multicore_fifo_push_blocking((uint32_t)(uintptr_t)service);
+}
+
+bool fm_service_send(fm_service_t *service, const fm_command_t *command) {
+    return queue_try_add(&service->commands, command);
+}
+
+bool fm_service_poll_event(fm_service_t *service, fm_event_t *event) {
+    return queue_try_remove(&service->events, event);
+}
+
+void fm_service_get_rds(fm_service_t *service, rds_parser_t *parser) {
+    critical_section_enter_blocking(&service->rds_lock);
+    memcpy(parser, &service->rds_parser, sizeof(rds_parser_t));
+    critical_section_exit(&service->rds_lock);
+}
+
+bool fm_service_power_up(fm_service_t *service, fm_config_t config) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_POWER_UP, .config = config});
+}
+
+bool fm_service_power_down(fm_service_t *service) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_POWER_DOWN});
+}
+
+bool fm_service_set_frequency(fm_service_t *service, float frequency) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_SET_FREQUENCY, .frequency = frequency});
+}
+
+bool fm_service_seek(fm_service_t *service, fm_seek_direction_t direction) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_SEEK, .direction = direction});
+}
+
+bool fm_service_cancel(fm_service_t *service) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_CANCEL});
+}
+
+bool fm_service_set_volume(fm_service_t *service, uint8_t volume, bool volext) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_SET_VOLUME, .volume = volume, .volext = volext});
+}
+
+bool fm_service_set_mute(fm_service_t *service, bool mute) {
+    return fm_service_send(service, &(fm_command_t){.type = FM_COMMAND_SET_MUTE, .flag = mute});
+}
@@ -0,0 +1,220 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_SERVICE_H_
+#define _FM_SERVICE_H_
+
+#include <fm_si470x.h>
+#include <rds_parser.h>
+#include <pico/critical_section.h>
+#include <pico/util/queue.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_service.h
+ *
+ * \brief Radio service running on core1.
+ *
+ * Moves all radio work to the second core: I2C transfers, async task ticks, RDS reading and
+ * parsing. Core0 sends commands and receives events through queues, so it never blocks on
+ * the I2C bus.
+ *
+ * While the service is running, the radio must not be accessed directly from core0.
+ */
+
+#ifndef FM_SERVICE_COMMAND_QUEUE_SIZE
+#define FM_SERVICE_COMMAND_QUEUE_SIZE 8
+#endif
+
+#ifndef FM_SERVICE_EVENT_QUEUE_SIZE
+#define FM_SERVICE_EVENT_QUEUE_SIZE 32
+#endif
+
+/**
+ * \brief Service command types.
+ */
+typedef enum fm_command_type_t
+{
+    FM_COMMAND_POWER_UP, /**< Power up with config. */
+    FM_COMMAND_POWER_DOWN,
+    FM_COMMAND_SET_FREQUENCY, /**< Tune to frequency. Cancels a running tune / seek. */
+    FM_COMMAND_SEEK, /**< Seek in direction. Cancels a running tune / seek. */
+    FM_COMMAND_CANCEL, /**< Cancel a running tune / seek. */
+    FM_COMMAND_SET_SEEK_SENSITIVITY, /**< Set seek_sensitivity. */
+    FM_COMMAND_SET_VOLUME, /**< Set volume and volext. */
+    FM_COMMAND_SET_MUTE, /**< Set mute from flag. */
+    FM_COMMAND_SET_SOFTMUTE, /**< Set softmute from flag. */
+    FM_COMMAND_SET_MONO, /**< Set mono from flag. */
+    FM_COMMAND_SET_SIGNAL_INTERVAL, /**< Set interval_ms between FM_EVENT_SIGNAL samples, 0 to disable. */
+} fm_command_type_t;
+
+/**
+ * \brief Service command.
+ */
+typedef struct fm_command_t
+{
+    fm_command_type_t type;
+    union
+    {
+        fm_config_t config;
+        float frequency;
+        fm_seek_direction_t direction;
+        fm_seek_sensitivity_t seek_sensitivity;
+        struct
+        {
+            uint8_t volume;
+            bool volext;
+        };
+        bool flag;
+        uint32_t interval_ms;
+    };
+} fm_command_t;
+
+/**
+ * \brief Service event types.
+ */
+typedef enum fm_event_type_t
+{
+    FM_EVENT_POWERED_UP, /**< Radio powered up, frequency restored. */
+    FM_EVENT_POWERED_DOWN,
+    FM_EVENT_TUNE_COMPLETE, /**< Tune / seek finished, see frequency and result. */
+    FM_EVENT_SIGNAL, /**< Periodic sample, see rssi and stereo. */
+    FM_EVENT_RDS_GROUP, /**< Raw RDS group, see rds_group. */
+    FM_EVENT_PS_CHANGED, /**< Program service name changed, see ps_str. */
+    FM_EVENT_RT_CHANGED, /**< Radio text changed, call fm_service_get_rds() to read it. */
+} fm_event_type_t;
+
+/**
+ * \brief Service event.
+ */
+typedef struct fm_event_t
+{
+    fm_event_type_t type;
+    union
+    {
+        struct
+        {
+            float frequency;
+            int result;
+        };
+        struct
+        {
+            uint8_t rssi;
+            bool stereo;
+        };
+        rds_group_t rds_group;
+        char ps_str[9];
+    };
+} fm_event_t;
+
+/**
+ * \brief Radio service.
+ */
+typedef struct fm_service_t
+{
+    si470x_t *radio;
+    queue_t commands;
+    queue_t events;
+    uint32_t dropped_events;
+    bool rds_group_events;
+    uint32_t signal_interval_ms;
+    uint64_t next_signal_time;
+    uint64_t next_rds_time;
+    critical_section_t rds_lock;
+    rds_parser_t rds_parser; // guarded by rds_lock
+} fm_service_t;
+
+/**
+ * \brief Initialize the service.
+ *
+ * @param service Service handle.
+ * @param radio Radio, already initialized with fm_init(). May be powered up.
+ * @param rds_group_events Whether to post FM_EVENT_RDS_GROUP for every received group.
+ */
+void fm_service_init(fm_service_t *service, si470x_t *radio, bool rds_group_events);
+
+/**
+ * \brief Start the service on core1.
+ *
+ * Core1 must be idle. If interrupts are used, fm_enable_interrupts() should be called before
+ * starting the service.
+ *
+ * @param service Service handle.
+ */
+void fm_service_launch(fm_service_t *service);
+
+/**
+ * \brief Queue a command for the service.
+ *
+ * @param service Service handle.
+ * @param command Command to copy.
+ * @return true Command queued.
+ * @return false Command queue full.
+ */
+bool fm_service_send(fm_service_t *service, const fm_command_t *command);
+
+/**
+ * \brief Get the next event from the service.
+ *
+ * Events are dropped if the queue fills up, so this should be called regularly.
+ *
+ * @param service Service handle.
+ * @param event Output event.
+ * @return true An event was removed from the queue.
+ * @return false No pending events.
+ */
+bool fm_service_poll_event(fm_service_t *service, fm_event_t *event);
+
+/**
+ * \brief Get a consistent copy of the RDS parser state.
+ *
+ * @param service Service handle.
+ * @param parser Output parser.
+ */
+void fm_service_get_rds(fm_service_t *service, rds_parser_t *parser);
+
+/**
+ * \brief Send FM_COMMAND_POWER_UP.
+ */
+bool fm_service_power_up(fm_service_t *service, fm_config_t config);
+
+/**
+ * \brief Send FM_COMMAND_POWER_DOWN.
+ */
+bool fm_service_power_down(fm_service_t *service);
+
+/**
+ * \brief Send FM_COMMAND_SET_FREQUENCY.
+ */
+bool fm_service_set_frequency(fm_service_t *service, float frequency);
+
+/**
+ * \brief Send FM_COMMAND_SEEK.
+ */
+bool fm_service_seek(fm_service_t *service, fm_seek_direction_t direction);
+
+/**
+ * \brief Send FM_COMMAND_CANCEL.
+ */
+bool fm_service_cancel(fm_service_t *service);
+
+/**
+ * \brief Send FM_COMMAND_SET_VOLUME.
+ */
+bool fm_service_set_volume(fm_service_t *service, uint8_t volume, bool volext);
+
+/**
+ * \brief Send FM_COMMAND_SET_MUTE.
+ */
+bool fm_service_set_mute(fm_service_t *service, bool mute);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_SERVICE_H_
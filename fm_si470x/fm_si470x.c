@@ -6,6 +6,7 @@
 
 #include "fm_si470x_regs.h"
 #include <fm_si470x.h>
+#include <hardware/dma.h>
 #include <hardware/i2c.h>
 #include <pico/stdlib.h>
 #include <math.h>
@@ -14,67 +15,123 @@
 #define DEV_SI4702 0b0001
 #define DEV_SI4703 0b1001
 
+#define GPIO2_STC_RDS_INTERRUPT 0b01
+
+static const uint TUNE_EXPECTED_MS = 60; // datasheet seek / tune time per channel, first STC poll is delayed this long
+static const uint TUNE_MIN_POLL_INTERVAL_MS = 2;
 static const uint TUNE_POLL_INTERVAL_MS = 20;
+static const uint SEEK_MIN_POLL_INTERVAL_MS = 20;
 static const uint SEEK_POLL_INTERVAL_MS = 200; // relatively large, to reduce electrical interference from I2C
+static const uint IRQ_POLL_INTERVAL_MS = 1; // checking interrupt flags doesn't touch the bus
+static const uint STC_CLEAR_POLL_INTERVAL_US = 250;
+static const uint STC_CLEAR_MAX_POLLS = 8; // STC should clear within 1.5ms
+static const uint SCAN_POLL_INTERVAL_MS = 5; // scanning is time-critical, audio quality doesn't matter
+static const uint SCAN_RDS_POLL_INTERVAL_MS = 20;
 
 //
 // misc
 //
 
-static fm_frequency_range_t fm_frequency_range(fm_band_t band, fm_channel_spacing_t channel_spacing) {
-    fm_frequency_range_t range;
+static fm_frequency_range_10khz_t fm_frequency_range_10khz(fm_band_t band, fm_channel_spacing_t channel_spacing) {
+    fm_frequency_range_10khz_t range;
     switch (band) {
     case FM_BAND_COMMON:
-        range.bottom = 87.5f;
-        range.top = 108.0f;
+        range.bottom = 8750;
+        range.top = 10800;
         break;
     case FM_BAND_JAPAN_WIDE:
-        range.bottom = 76.0f;
-        range.top = 108.0f;
+        range.bottom = 7600;
+        range.top = 10800;
         break;
     default: // FM_BAND_JAPAN
-        range.bottom = 76.0f;
-        range.top = 90.0f;
+        range.bottom = 7600;
+        range.top = 9000;
         break;
     }
     switch (channel_spacing) {
     case FM_CHANNEL_SPACING_200:
-        range.spacing = 0.2f;
+        range.spacing = 20;
         break;
     case FM_CHANNEL_SPACING_100:
-        range.spacing = 0.1f;
+        range.spacing = 10;
         break;
     default: // FM_CHANNEL_SPACING_50
-        range.spacing = 0.05f;
+        range.spacing = 5;
         break;
     }
     return range;
 }
 
-static float fm_channel_to_frequency(uint16_t channel, fm_frequency_range_t range) {
-    return channel * range.spacing + range.bottom;
+static uint16_t fm_channel_to_frequency(uint16_t channel, fm_frequency_range_10khz_t range) {
+    return range.bottom + channel * range.spacing;
+}
+
+static uint16_t fm_frequency_to_channel(uint16_t frequency, fm_frequency_range_10khz_t range) {
+    assert(range.bottom <= frequency && frequency <= range.top);
+
+    return (frequency - range.bottom + range.spacing / 2) / range.spacing;
+}
+
+static uint16_t fm_get_top_channel(fm_frequency_range_10khz_t range) {
+    return (range.top - range.bottom) / range.spacing;
+}
+
+static uint16_t fm_mhz_to_10khz(float frequency) {
+    return (uint16_t)roundf(frequency * 100.0f);
 }
 
-static uint16_t fm_frequency_to_channel(float frequency, fm_frequency_range_t range) {
-    return (uint16_t)roundf((frequency - range.bottom) / range.spacing);
+static float fm_10khz_to_mhz(uint16_t frequency) {
+    return frequency / 100.0f;
 }
 
 //
 // register access
 //
 
-static bool fm_read_registers(i2c_inst_t *i2c_inst, uint16_t *regs, size_t n) {
-    assert(n <= 16); // registers 0xA..0xF, followed by 0x0..0x9
+static size_t fm_read_count_up_to(uint8_t reg_index) {
+    // read order: 0xA, 0xB, 0xC, 0xD, 0xE, 0xF, 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9
+    assert(reg_index < 16);
 
-    uint8_t buf[32];
-    size_t data_size = n * sizeof(uint16_t);
-    int result = i2c_read_blocking(i2c_inst, SI4703_ADDR, buf, data_size, false);
-    if (result != (int)data_size) {
-        return false; // failed
+    if (reg_index < 0xA) {
+        return reg_index + 7;
+    } else {
+        return reg_index - 9;
+    }
+}
+
+static size_t fm_write_count_up_to(uint8_t reg_index) {
+    // write order: 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF
+    assert(0x2 <= reg_index && reg_index <= 0xF);
+
+    return reg_index - 1;
+}
+
+#if FM_SI470X_STATS_ENABLE
+#define fm_stats_add(radio, counter, value) ((radio)->stats.counter += (value))
+#else
+#define fm_stats_add(radio, counter, value) ((void)0)
+#endif
+
+static void fm_registers_read(si470x_t *radio, size_t n) {
+    if (fm_read_count_up_to(RDSD) <= n) {
+        // status snapshot refreshed, a pending RDS group hasn't been returned yet
+        radio->status_read_time = time_us_64();
+        radio->status_rds_consumed = false;
     }
+}
+
+static uint16_t fm_registers_written(si470x_t *radio, size_t written_count) {
+    // registers 0x2..(0x2 + written_count - 1) are now in sync with the chip, returns those that were dirty
+    uint16_t written = (uint16_t)(((1u << written_count) - 1) << 0x2);
+    uint16_t dirty = radio->dirty_regs & written;
+    radio->dirty_regs &= ~written;
+    radio->status_read_time = 0; // writes may change status, e.g. start tuning
+    return dirty;
+}
 
+static void fm_unpack_registers(uint16_t *regs, const uint8_t *buf, size_t n) {
     uint16_t *p = regs + 0xA;
-    for (size_t i = 0; i < data_size;) {
+    for (size_t i = 0; i < 2 * n;) {
         uint16_t reg = buf[i++] << 8; // hi
         reg |= buf[i++]; // lo
         *p = reg;
@@ -82,43 +139,280 @@ static bool fm_read_registers(i2c_inst_t *i2c_inst, uint16_t *regs, size_t n) {
             p = regs; // loop back to register 0
         }
     }
-    return true;
 }
 
-static bool fm_read_registers_up_to(i2c_inst_t *i2c_inst, uint16_t *regs, uint8_t reg_index) {
-    // read order: 0xA, 0xB, 0xC, 0xD, 0xE, 0xF, 0x0, 0x1, 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9
-    assert(reg_index < 16);
+static void fm_select_bus(si470x_t *radio) {
+    if (radio->bus_select != NULL) {
+        radio->bus_select(radio, radio->bus_select_data);
+    }
+}
 
-    size_t n;
-    if (reg_index < 0xA) {
-        n = reg_index + 7;
+//
+// DMA transfers
+//
+
+typedef enum fm_dma_status_t
+{
+    FM_DMA_BUSY,
+    FM_DMA_DONE,
+    FM_DMA_FAILED,
+} fm_dma_status_t;
+
+static bool fm_dma_is_enabled(si470x_t *radio) {
+    return radio->dma.tx_channel >= 0;
+}
+
+static void fm_dma_start(si470x_t *radio, size_t cmd_count, bool read) {
+    fm_dma_state_t *dma = &radio->dma;
+    i2c_inst_t *i2c_inst = radio->i2c_inst;
+    i2c_hw_t *hw = i2c_get_hw(i2c_inst);
+
+    fm_select_bus(radio);
+
+    hw->enable = 0;
+    hw->tar = SI4703_ADDR;
+    hw->enable = 1;
+    (void)hw->clr_tx_abrt;
+    (void)hw->clr_stop_det;
+    i2c_inst->restart_on_next = false;
+
+    if (read) {
+        dma_channel_config rx_config = dma_channel_get_default_config(dma->rx_channel);
+        channel_config_set_transfer_data_size(&rx_config, DMA_SIZE_8);
+        channel_config_set_read_increment(&rx_config, false);
+        channel_config_set_write_increment(&rx_config, true);
+        channel_config_set_dreq(&rx_config, i2c_get_dreq(i2c_inst, false));
+        dma_channel_configure(dma->rx_channel, &rx_config, dma->data_buf, &hw->data_cmd, cmd_count, true);
+    }
+
+    dma_channel_config tx_config = dma_channel_get_default_config(dma->tx_channel);
+    channel_config_set_transfer_data_size(&tx_config, DMA_SIZE_16);
+    channel_config_set_read_increment(&tx_config, true);
+    channel_config_set_write_increment(&tx_config, false);
+    channel_config_set_dreq(&tx_config, i2c_get_dreq(i2c_inst, true));
+    dma_channel_configure(dma->tx_channel, &tx_config, &hw->data_cmd, dma->cmd_buf, cmd_count, true);
+
+    dma->busy = true;
+    dma->read = read;
+    dma->reg_count = cmd_count / 2;
+}
+
+static void fm_dma_start_read(si470x_t *radio, size_t n) {
+    assert(n <= 16);
+
+    uint16_t *cmd_buf = radio->dma.cmd_buf;
+    size_t data_size = n * sizeof(uint16_t);
+    for (size_t i = 0; i < data_size; i++) {
+        cmd_buf[i] = I2C_IC_DATA_CMD_CMD_BITS; // read byte
+    }
+    cmd_buf[data_size - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    fm_dma_start(radio, data_size, true);
+}
+
+static void fm_dma_start_write(si470x_t *radio, size_t n) {
+    assert(n <= 14);
+
+    // changes made while the transfer is pending mark their registers dirty again
+    radio->dma.written_regs = fm_registers_written(radio, n);
+
+    uint16_t *cmd_buf = radio->dma.cmd_buf;
+    size_t data_size = n * sizeof(uint16_t);
+    const uint16_t *p = radio->regs + 0x2;
+    for (size_t i = 0; i < data_size;) {
+        uint16_t reg = *p++;
+        cmd_buf[i++] = reg >> 8; // hi
+        cmd_buf[i++] = reg & 0xFF; // lo
+    }
+    cmd_buf[data_size - 1] |= I2C_IC_DATA_CMD_STOP_BITS;
+    fm_dma_start(radio, data_size, false);
+}
+
+static fm_dma_status_t fm_dma_poll(si470x_t *radio) {
+    fm_dma_state_t *dma = &radio->dma;
+    if (!dma->busy) {
+        return FM_DMA_DONE;
+    }
+    i2c_hw_t *hw = i2c_get_hw(radio->i2c_inst);
+    if (hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS) {
+        // not acknowledged, the controller flushes its FIFO and issues a stop
+        dma_channel_abort(dma->tx_channel);
+        if (dma->read) {
+            dma_channel_abort(dma->rx_channel);
+        }
+        (void)hw->clr_tx_abrt;
+        dma->busy = false;
+        if (!dma->read) {
+            radio->dirty_regs |= dma->written_regs; // retried by the next write
+        }
+        fm_stats_add(radio, i2c_transfers, 1);
+        fm_stats_add(radio, i2c_failures, 1);
+        return FM_DMA_FAILED;
+    }
+    if (dma->read) {
+        if (dma_channel_is_busy(dma->rx_channel)) {
+            return FM_DMA_BUSY;
+        }
+        fm_unpack_registers(radio->regs, dma->data_buf, dma->reg_count);
+        fm_registers_read(radio, dma->reg_count);
+        fm_stats_add(radio, i2c_bytes_read, dma->reg_count * sizeof(uint16_t));
     } else {
-        n = reg_index - 9;
+        if (dma_channel_is_busy(dma->tx_channel) || !(hw->raw_intr_stat & I2C_IC_RAW_INTR_STAT_STOP_DET_BITS)) {
+            return FM_DMA_BUSY; // commands may still be in the FIFO
+        }
+        fm_stats_add(radio, i2c_bytes_written, dma->reg_count * sizeof(uint16_t));
+    }
+    dma->busy = false;
+    fm_stats_add(radio, i2c_transfers, 1);
+    return FM_DMA_DONE;
+}
+
+static bool fm_dma_wait(si470x_t *radio) {
+    fm_dma_status_t status;
+    while ((status = fm_dma_poll(radio)) == FM_DMA_BUSY) {
+        tight_loop_contents();
+    }
+    return status == FM_DMA_DONE;
+}
+
+//
+// blocking transfers
+//
+
+static bool fm_read_raw(si470x_t *radio, uint8_t *buf, size_t n) {
+    assert(n <= 16); // registers 0xA..0xF, followed by 0x0..0x9
+
+    fm_dma_wait(radio); // don't interleave with a pending transfer
+    fm_select_bus(radio);
+
+    size_t data_size = n * sizeof(uint16_t);
+    bool success;
+    if (radio->transport != NULL) {
+        success = radio->transport->read(radio->transport_context, SI4703_ADDR, buf, data_size);
+    } else {
+        success = i2c_read_blocking(radio->i2c_inst, SI4703_ADDR, buf, data_size, false) == (int)data_size;
+    }
+    fm_stats_add(radio, i2c_transfers, 1);
+    if (!success) {
+        fm_stats_add(radio, i2c_failures, 1);
+        return false; // failed
+    }
+    fm_stats_add(radio, i2c_bytes_read, data_size);
+    return true;
+}
+
+static bool fm_read_registers(si470x_t *radio, size_t n) {
+    uint8_t buf[32];
+    if (!fm_read_raw(radio, buf, n)) {
+        return false;
     }
-    return fm_read_registers(i2c_inst, regs, n);
+    fm_unpack_registers(radio->regs, buf, n);
+    fm_registers_read(radio, n);
+    return true;
+}
+
+static bool fm_read_registers_up_to(si470x_t *radio, uint8_t reg_index) {
+    return fm_read_registers(radio, fm_read_count_up_to(reg_index));
 }
 
-static bool fm_write_registers(i2c_inst_t *i2c_inst, uint16_t *regs, size_t n) {
+static void fm_read_status_up_to(si470x_t *radio, uint8_t reg_index) {
+    // with a max age, status is read in full and served from cache while fresh
+    if (radio->status_max_age_us == 0) {
+        fm_read_registers_up_to(radio, reg_index);
+        return;
+    }
+    if (radio->status_read_time != 0 && time_us_64() - radio->status_read_time <= radio->status_max_age_us) {
+        return;
+    }
+    fm_read_registers_up_to(radio, RDSD);
+}
+
+static bool fm_write_registers(si470x_t *radio, size_t n) {
     assert(n <= 14); // register 0x2..0xF
 
+    fm_dma_wait(radio); // don't interleave with a pending transfer
+    fm_select_bus(radio);
+
     uint8_t buf[28];
     size_t data_size = n * sizeof(uint16_t);
-    uint16_t *p = regs + 0x2;
+    uint16_t *p = radio->regs + 0x2;
     for (size_t i = 0; i < data_size;) {
         uint16_t reg = *p++;
         buf[i++] = reg >> 8; // hi
         buf[i++] = reg & 0xFF; // lo
     }
-    int result = i2c_write_blocking(i2c_inst, SI4703_ADDR, buf, data_size, false);
-    return result == (int)data_size;
+    bool success;
+    if (radio->transport != NULL) {
+        success = radio->transport->write(radio->transport_context, SI4703_ADDR, buf, data_size);
+    } else {
+        success = i2c_write_blocking(radio->i2c_inst, SI4703_ADDR, buf, data_size, false) == (int)data_size;
+    }
+    fm_stats_add(radio, i2c_transfers, 1);
+    if (!success) {
+        fm_stats_add(radio, i2c_failures, 1);
+        radio->status_read_time = 0; // may have been partially written
+        return false; // failed, still dirty
+    }
+    fm_registers_written(radio, n);
+    fm_stats_add(radio, i2c_bytes_written, data_size);
+    return true;
 }
 
-static bool fm_write_registers_up_to(i2c_inst_t *i2c_inst, uint16_t *regs, uint8_t reg_index) {
-    // write order: 0x2, 0x3, 0x4, 0x5, 0x6, 0x7, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF
+static bool fm_write_registers_up_to(si470x_t *radio, uint8_t reg_index) {
+    return fm_write_registers(radio, fm_write_count_up_to(reg_index));
+}
+
+static void fm_mark_dirty(si470x_t *radio, uint8_t reg_index) {
     assert(0x2 <= reg_index && reg_index <= 0xF);
 
-    size_t n = reg_index - 1;
-    return fm_write_registers(i2c_inst, regs, n);
+    radio->dirty_regs |= 1u << reg_index;
+}
+
+static uint8_t fm_last_dirty_register(si470x_t *radio) {
+    // writes always start at register 0x2, so the shortest write ends at the highest dirty register
+    return 31 - __builtin_clz(radio->dirty_regs);
+}
+
+static bool fm_flush_registers(si470x_t *radio) {
+    // while an async task is running, changes are written between its polls, see fm_async_flush_registers()
+    if (radio->update_depth != 0 || radio->dirty_regs == 0 || radio->async.task != NULL) {
+        return true;
+    }
+    return fm_write_registers_up_to(radio, fm_last_dirty_register(radio));
+}
+
+//
+// non-blocking transfers, used from async tasks
+//
+
+static void fm_start_write_registers_up_to(si470x_t *radio, uint8_t reg_index) {
+    // with DMA, completion is awaited by the next transfer
+    if (fm_dma_is_enabled(radio)) {
+        fm_dma_wait(radio);
+        fm_dma_start_write(radio, fm_write_count_up_to(reg_index));
+    } else {
+        fm_write_registers_up_to(radio, reg_index);
+    }
+}
+
+static bool fm_poll_registers_up_to(si470x_t *radio, uint8_t reg_index) {
+    // with DMA, the first call starts the transfer and returns false, later calls
+    // return true once the registers have been updated
+    if (!fm_dma_is_enabled(radio)) {
+        fm_read_registers_up_to(radio, reg_index);
+        return true;
+    }
+    fm_dma_state_t *dma = &radio->dma;
+    if (dma->busy) {
+        bool covered = dma->read && fm_read_count_up_to(reg_index) <= dma->reg_count;
+        if (fm_dma_poll(radio) == FM_DMA_BUSY) {
+            return false;
+        }
+        if (covered) {
+            return true; // possibly stale if the transfer failed, caller polls again
+        }
+    }
+    fm_dma_start_read(radio, fm_read_count_up_to(reg_index));
+    return false;
 }
 
 #define fm_set_bit(reg, bit, value) \
@@ -169,6 +463,84 @@ static void fm_set_seek_sensitivity_bits(uint16_t *regs, fm_seek_sensitivity_t s
     fm_set_bits(regs[SYSCONFIG3], SKCNT, skcnt);
 }
 
+static void fm_set_interrupt_bits(si470x_t *radio) {
+    uint16_t *regs = radio->regs;
+    fm_set_bit(regs[SYSCONFIG1], STCIEN, radio->irq_enabled);
+    fm_set_bit(regs[SYSCONFIG1], RDSIEN, radio->irq_enabled && fm_is_rds_supported(radio));
+    fm_set_bits(regs[SYSCONFIG1], GPIO2, radio->irq_enabled ? GPIO2_STC_RDS_INTERRUPT : 0);
+}
+
+//
+// interrupts
+//
+
+static si470x_t *fm_irq_radios[NUM_BANK0_GPIOS];
+
+static void fm_gpio_irq_handler(void) {
+    for (uint pin = 0; pin < NUM_BANK0_GPIOS; pin++) {
+        si470x_t *radio = fm_irq_radios[pin];
+        if (radio == NULL || !(gpio_get_irq_event_mask(pin) & GPIO_IRQ_EDGE_FALL)) {
+            continue;
+        }
+        gpio_acknowledge_irq(pin, GPIO_IRQ_EDGE_FALL);
+        // GPIO2 is shared by both sources, let each consumer check its own status bit
+        radio->irq_rds_pending = true;
+        radio->irq_stc_pending = true;
+    }
+}
+
+static bool fm_consume_irq(volatile bool *pending) {
+    if (!*pending) {
+        return false;
+    }
+    // clear before reading registers, so an interrupt arriving meanwhile isn't lost
+    *pending = false;
+    return true;
+}
+
+//
+// async task polling
+//
+
+static void fm_async_start_polling(si470x_t *radio, uint min_interval_ms) {
+    // first poll when the operation is expected to be done, then with growing intervals
+    radio->async.resume_time = time_us_64() + TUNE_EXPECTED_MS * 1000;
+    radio->async.poll_interval_ms = min_interval_ms;
+}
+
+static void fm_async_backoff(si470x_t *radio, uint max_interval_ms) {
+    uint interval_ms = radio->async.poll_interval_ms;
+    radio->async.resume_time = time_us_64() + interval_ms * 1000;
+    radio->async.poll_interval_ms = MIN(2 * interval_ms, max_interval_ms);
+}
+
+static void fm_async_sleep_until_resume(si470x_t *radio) {
+    uint64_t now = time_us_64();
+    if (now < radio->async.resume_time) {
+        sleep_us(radio->async.resume_time - now);
+    }
+}
+
+static bool fm_poll_stc_cleared(si470x_t *radio) {
+    // After TUNE / SEEK has been reset, wait until STC bit cleared; shouldn't take longer than 1.5ms.
+    // Polls a limited number of times, sleeping in between. Returns false if STC hasn't cleared yet,
+    // or with DMA while a transfer is pending.
+    uint16_t *regs = radio->regs;
+    for (uint i = 0; i < STC_CLEAR_MAX_POLLS; i++) {
+        if (!fm_poll_registers_up_to(radio, READCHAN)) {
+            return false; // DMA transfer pending
+        }
+        fm_stats_add(radio, stc_polls, 1);
+        if (!fm_get_bit(regs[STATUSRSSI], STC)) {
+            uint16_t channel = fm_get_bits(regs[READCHAN], READCHAN);
+            radio->frequency = fm_channel_to_frequency(channel, fm_get_frequency_range_10khz(radio));
+            return true;
+        }
+        sleep_us(STC_CLEAR_POLL_INTERVAL_US);
+    }
+    return false;
+}
+
 //
 // public interface
 //
@@ -184,102 +556,244 @@ void fm_init(si470x_t *radio, i2c_inst_t *i2c_inst, uint8_t reset_pin, uint8_t s
     radio->seek_sensitivity = FM_SEEK_SENSITIVITY_RECOMMENDED;
     radio->mute = true;
     radio->softmute = true;
+    radio->dma.tx_channel = -1;
+    radio->dma.rx_channel = -1;
 }
 
-void fm_power_up(si470x_t *radio, fm_config_t config) {
+void fm_set_transport(si470x_t *radio, const fm_transport_t *transport, void *context) {
     assert(!fm_is_powered_up(radio));
+    assert(!fm_dma_is_enabled(radio));
 
-    i2c_inst_t *i2c_inst = radio->i2c_inst;
-    uint16_t *regs = radio->regs;
+    radio->transport = transport;
+    radio->transport_context = context;
+}
 
-    if (fm_get_bit(regs[POWERCFG], DISABLE)) {
-        // waking up after power down, assume registers have been preserved
-        if (memcmp(&radio->config, &config, sizeof(config)) == 0) {
-            fm_set_bit(regs[POWERCFG], ENABLE, true);
-            fm_set_bit(regs[POWERCFG], DISABLE, false);
-            fm_set_bit(regs[POWERCFG], DMUTE, !radio->mute);
-            fm_write_registers_up_to(i2c_inst, regs, POWERCFG);
-            sleep_ms(110); // wait for device powerup
-
-            // restore RDS
-            if (fm_is_rds_supported(radio)) {
-                fm_set_bit(regs[SYSCONFIG1], RDS, true);
-                fm_write_registers_up_to(i2c_inst, regs, SYSCONFIG1);
-            }
-            return;
-        }
-    }
+void fm_set_bus_select(si470x_t *radio, fm_bus_select_t bus_select, void *user_data) {
+    radio->bus_select = bus_select;
+    radio->bus_select_data = user_data;
+}
 
-    radio->config = config;
+bool fm_is_bus_busy(si470x_t *radio) {
+    return radio->dma.busy;
+}
 
-    gpio_init(radio->reset_pin);
-    gpio_set_dir(radio->reset_pin, GPIO_OUT);
-    gpio_init(radio->sdio_pin);
-    gpio_set_dir(radio->sdio_pin, GPIO_OUT);
+bool fm_enable_dma(si470x_t *radio) {
+    assert(!fm_dma_is_enabled(radio));
+    assert(radio->transport == NULL); // DMA drives the hardware I2C controller
 
-    // see AN230 - Powerup Configuration Sequence
-    gpio_put(radio->sdio_pin, false);
-    gpio_put(radio->reset_pin, false);
-    sleep_ms(5);
-    gpio_put(radio->reset_pin, true);
-    sleep_ms(5);
+    int tx_channel = dma_claim_unused_channel(false);
+    int rx_channel = dma_claim_unused_channel(false);
+    if (tx_channel < 0 || rx_channel < 0) {
+        if (tx_channel >= 0) {
+            dma_channel_unclaim(tx_channel);
+        }
+        if (rx_channel >= 0) {
+            dma_channel_unclaim(rx_channel);
+        }
+        return false;
+    }
+    radio->dma.tx_channel = tx_channel;
+    radio->dma.rx_channel = rx_channel;
+    return true;
+}
 
-    gpio_set_function(radio->sdio_pin, GPIO_FUNC_I2C);
-    gpio_set_function(radio->sclk_pin, GPIO_FUNC_I2C);
-    if (radio->enable_pull_ups) {
-        gpio_pull_up(radio->sdio_pin);
-        gpio_pull_up(radio->sclk_pin);
+void fm_enable_interrupts(si470x_t *radio, uint8_t gpio2_pin) {
+    assert(!radio->irq_enabled);
+    assert(gpio2_pin < NUM_BANK0_GPIOS && fm_irq_radios[gpio2_pin] == NULL);
+
+    static bool handler_installed = false;
+    if (!handler_installed) {
+        gpio_add_raw_irq_handler(gpio2_pin, fm_gpio_irq_handler);
+        handler_installed = true;
     }
 
-    if (!fm_read_registers(i2c_inst, regs, 16)) {
-        panic("FM - couldn't read from I2C bus, check your wiring");
+    gpio_init(gpio2_pin);
+    gpio_set_dir(gpio2_pin, GPIO_IN);
+    gpio_pull_up(gpio2_pin);
+
+    radio->irq_pin = gpio2_pin;
+    radio->irq_enabled = true;
+    // poll once, in case an event is already waiting
+    radio->irq_rds_pending = true;
+    radio->irq_stc_pending = true;
+    fm_irq_radios[gpio2_pin] = radio;
+    gpio_set_irq_enabled(gpio2_pin, GPIO_IRQ_EDGE_FALL, true);
+    irq_set_enabled(IO_IRQ_BANK0, true);
+
+    if (fm_is_powered_up(radio)) {
+        fm_set_interrupt_bits(radio);
+        fm_mark_dirty(radio, SYSCONFIG1);
+        fm_flush_registers(radio);
     }
+}
+
+static void fm_set_config_bits(si470x_t *radio) {
+    uint16_t *regs = radio->regs;
+    fm_set_bit(regs[SYSCONFIG1], DE, radio->config.deemphasis == FM_DEEMPHASIS_50);
+    fm_set_bits(regs[SYSCONFIG2], BAND, radio->config.band);
+    fm_set_bits(regs[SYSCONFIG2], SPACE, radio->config.channel_spacing);
+}
+
+static void fm_power_up_setup(si470x_t *radio, uint8_t state) {
+    // final register setup, once the device has powered up
+    uint16_t *regs = radio->regs;
+    if (state == 4) {
+        // cold start
+        fm_read_registers(radio, 16);
 #ifndef NDEBUG
-    uint16_t mfgid = fm_get_bits(regs[DEVICEID], MFGID);
-    uint8_t pn = fm_get_bits(regs[DEVICEID], PN);
-    assert(mfgid == 0x242); // manufacturer ID check
-    assert(pn == 0x1); // part number check
+        uint8_t dev = fm_get_bits(regs[CHIPID], DEV);
+        assert(dev == DEV_SI4702 || dev == DEV_SI4703);
+        // Si4700 / Si4701 lack the SYSCONFIG3 and TEST1 settings. They should work with minor tweaks.
 #endif
 
-    regs[TEST1] |= XOSCEN_BIT; // enable internal oscillator
-    regs[RDSD] = 0; // Si4703-C19 errata - ensure RDSD register is zero
-    fm_write_registers_up_to(i2c_inst, regs, RDSD);
-    sleep_ms(500); // wait for oscillator to stabilize
+        fm_set_bit(regs[POWERCFG], MONO, radio->mono);
+        fm_set_bit(regs[POWERCFG], RDSM, radio->rds_verbose);
+        fm_set_bit(regs[POWERCFG], DMUTE, !radio->mute);
+        fm_set_bit(regs[POWERCFG], DSMUTE, !radio->softmute);
+        if (fm_is_rds_supported(radio)) {
+            fm_set_bit(regs[SYSCONFIG1], RDS, true);
+        }
+        fm_set_config_bits(radio);
+        fm_set_interrupt_bits(radio);
+        fm_set_bits(regs[SYSCONFIG2], VOLUME, radio->volume);
+        fm_set_bit(regs[SYSCONFIG3], VOLEXT, radio->volext);
+        fm_set_bits(regs[SYSCONFIG3], SMUTEA, radio->softmute_attenuation);
+        fm_set_bits(regs[SYSCONFIG3], SMUTER, radio->softmute_rate);
+        fm_set_seek_sensitivity_bits(regs, radio->seek_sensitivity);
+        fm_write_registers_up_to(radio, SYSCONFIG3);
+    } else {
+        // warm start, restore RDS and interrupts
+        fm_set_bit(regs[SYSCONFIG1], RDS, fm_is_rds_supported(radio));
+        fm_set_interrupt_bits(radio);
+        if (state == 6) {
+            // config changed, the remaining registers are still valid
+            fm_set_config_bits(radio);
+            fm_write_registers_up_to(radio, SYSCONFIG2);
+        } else if (fm_is_rds_supported(radio) || radio->irq_enabled) {
+            fm_write_registers_up_to(radio, SYSCONFIG1);
+        }
+    }
+}
+
+static fm_async_progress_t fm_power_up_async_task(si470x_t *radio, bool cancel) {
+    assert(radio->async.task == &fm_power_up_async_task);
+
+    uint16_t *regs = radio->regs;
+    if (cancel) {
+        if (radio->async.state >= 4) {
+            // already enabled, finish setup so the radio is usable
+            fm_async_sleep_until_resume(radio);
+            fm_power_up_setup(radio, radio->async.state);
+        }
+        return (fm_async_progress_t){.done = true, -1};
+    }
 
-    // enable
-    regs[POWERCFG] = ENABLE_BIT;
-    fm_write_registers_up_to(i2c_inst, regs, POWERCFG);
-    sleep_ms(110); // wait for device powerup
+    switch (radio->async.state) {
+    case 1: // cold start, reset asserted
+        gpio_put(radio->reset_pin, true);
+        radio->async.state = 2;
+        radio->async.resume_time = time_us_64() + 5 * 1000;
+        return (fm_async_progress_t){.done = false};
 
-    fm_read_registers(i2c_inst, regs, 16);
+    case 2: // reset released, SDIO low selected 2-wire mode
+        if (radio->transport != NULL) {
+            radio->transport->init_pins(radio->transport_context, radio->sdio_pin, radio->sclk_pin, radio->enable_pull_ups);
+        } else {
+            gpio_set_function(radio->sdio_pin, GPIO_FUNC_I2C);
+            gpio_set_function(radio->sclk_pin, GPIO_FUNC_I2C);
+            if (radio->enable_pull_ups) {
+                gpio_pull_up(radio->sdio_pin);
+                gpio_pull_up(radio->sclk_pin);
+            }
+        }
+
+        if (!fm_read_registers(radio, 16)) {
+            panic("FM - couldn't read from I2C bus, check your wiring");
+        }
 #ifndef NDEBUG
-    uint8_t dev = fm_get_bits(regs[CHIPID], DEV);
-    assert(dev == DEV_SI4702 || dev == DEV_SI4703);
-    // Si4700 / Si4701 lack the SYSCONFIG3 and TEST1 settings. They should work with minor tweaks.
+        uint16_t mfgid = fm_get_bits(regs[DEVICEID], MFGID);
+        uint8_t pn = fm_get_bits(regs[DEVICEID], PN);
+        assert(mfgid == 0x242); // manufacturer ID check
+        assert(pn == 0x1); // part number check
 #endif
 
-    // setup
-    fm_set_bit(regs[POWERCFG], MONO, radio->mono);
-    fm_set_bit(regs[POWERCFG], DMUTE, !radio->mute);
-    fm_set_bit(regs[POWERCFG], DSMUTE, !radio->softmute);
-    if (fm_is_rds_supported(radio)) {
-        fm_set_bit(regs[SYSCONFIG1], RDS, true);
+        regs[TEST1] |= XOSCEN_BIT; // enable internal oscillator
+        regs[RDSD] = 0; // Si4703-C19 errata - ensure RDSD register is zero
+        fm_write_registers_up_to(radio, RDSD);
+        radio->async.state = 3;
+        radio->async.resume_time = time_us_64() + 500 * 1000; // wait for oscillator to stabilize
+        return (fm_async_progress_t){.done = false};
+
+    case 3: // oscillator running
+        regs[POWERCFG] = ENABLE_BIT;
+        fm_write_registers_up_to(radio, POWERCFG);
+        radio->async.state = 4;
+        radio->async.resume_time = time_us_64() + 110 * 1000; // wait for device powerup
+        return (fm_async_progress_t){.done = false};
+
+    default: // 4 - cold start, 5 - warm start, 6 - warm start with new config
+        break;
+    }
+
+    uint8_t state = radio->async.state;
+    fm_power_up_setup(radio, state);
+    if (radio->frequency == 0 || state == 5) {
+        return (fm_async_progress_t){.done = true, 0}; // no tuning needed
     }
-    fm_set_bit(regs[SYSCONFIG1], DE, config.deemphasis == FM_DEEMPHASIS_50);
-    fm_set_bits(regs[SYSCONFIG2], VOLUME, radio->volume);
-    fm_set_bits(regs[SYSCONFIG2], BAND, config.band);
-    fm_set_bits(regs[SYSCONFIG2], SPACE, config.channel_spacing);
-    fm_set_bit(regs[SYSCONFIG3], VOLEXT, radio->volext);
-    fm_set_bits(regs[SYSCONFIG3], SMUTEA, radio->softmute_attenuation);
-    fm_set_bits(regs[SYSCONFIG3], SMUTER, radio->softmute_rate);
-    fm_set_seek_sensitivity_bits(regs, radio->seek_sensitivity);
-    fm_write_registers_up_to(i2c_inst, regs, SYSCONFIG3);
 
-    if (radio->frequency != 0.0f) {
-        float frequency = radio->frequency;
-        radio->frequency = 0.0f;
-        fm_set_frequency_blocking(radio, frequency);
+    // restore frequency, within the band of the new config
+    uint16_t frequency = radio->frequency;
+    fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(radio);
+    if (frequency < range.bottom || range.top < frequency) {
+        frequency = range.bottom;
     }
+    radio->async.task = NULL; // hand over to tune task, keeping the callback
+    fm_set_frequency_10khz_async(radio, frequency);
+    return (fm_async_progress_t){.done = false};
+}
+
+void fm_power_up(si470x_t *radio, fm_config_t config) {
+    fm_power_up_async(radio, config);
+    fm_async_progress_t progress;
+    do {
+        fm_async_sleep_until_resume(radio);
+        progress = fm_async_task_tick(radio);
+    } while (!progress.done);
+}
+
+void fm_power_up_async(si470x_t *radio, fm_config_t config) {
+    assert(!fm_is_powered_up(radio));
+    assert(radio->async.task == NULL); // disallowed during async task
+
+    uint16_t *regs = radio->regs;
+    radio->async.task = fm_power_up_async_task;
+
+    if (fm_get_bit(regs[POWERCFG], DISABLE)) {
+        // waking up after power down, assume registers have been preserved
+        bool config_changed = (memcmp(&radio->config, &config, sizeof(config)) != 0);
+        radio->config = config;
+
+        fm_set_bit(regs[POWERCFG], ENABLE, true);
+        fm_set_bit(regs[POWERCFG], DISABLE, false);
+        fm_set_bit(regs[POWERCFG], DMUTE, !radio->mute);
+        fm_write_registers_up_to(radio, POWERCFG);
+        radio->async.state = config_changed ? 6 : 5;
+        radio->async.resume_time = time_us_64() + 110 * 1000; // wait for device powerup
+        return;
+    }
+
+    radio->config = config;
+
+    gpio_init(radio->reset_pin);
+    gpio_set_dir(radio->reset_pin, GPIO_OUT);
+    gpio_init(radio->sdio_pin);
+    gpio_set_dir(radio->sdio_pin, GPIO_OUT);
+
+    // see AN230 - Powerup Configuration Sequence
+    gpio_put(radio->sdio_pin, false);
+    gpio_put(radio->reset_pin, false);
+    radio->async.state = 1;
+    radio->async.resume_time = time_us_64() + 5 * 1000;
 }
 
 void fm_power_down(si470x_t *radio) {
@@ -295,12 +809,12 @@ void fm_power_down(si470x_t *radio) {
     if (fm_is_rds_supported(radio)) {
         // on Si4703 it's recommended to disable RDS before powering down (AN230 - Hardware Powerdown)
         fm_set_bit(regs[SYSCONFIG1], RDS, false);
-        fm_write_registers_up_to(radio->i2c_inst, regs, SYSCONFIG1);
+        fm_write_registers_up_to(radio, SYSCONFIG1);
     }
 
     fm_set_bit(regs[POWERCFG], DMUTE, false);
     fm_set_bit(regs[POWERCFG], DISABLE, true);
-    fm_write_registers_up_to(radio->i2c_inst, regs, POWERCFG);
+    fm_write_registers_up_to(radio, POWERCFG);
 
     // update shadow register for internal bookkeeping
     fm_set_bit(regs[POWERCFG], ENABLE, false);
@@ -324,73 +838,119 @@ fm_config_t fm_get_config(si470x_t *radio) {
 }
 
 fm_frequency_range_t fm_get_frequency_range(si470x_t *radio) {
-    return fm_frequency_range(radio->config.band, radio->config.channel_spacing);
+    fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(radio);
+    return (fm_frequency_range_t){
+        .bottom = fm_10khz_to_mhz(range.bottom),
+        .top = fm_10khz_to_mhz(range.top),
+        .spacing = fm_10khz_to_mhz(range.spacing),
+    };
+}
+
+fm_frequency_range_10khz_t fm_get_frequency_range_10khz(si470x_t *radio) {
+    return fm_frequency_range_10khz(radio->config.band, radio->config.channel_spacing);
 }
 
 float fm_get_frequency(si470x_t *radio) {
+    return fm_10khz_to_mhz(radio->frequency);
+}
+
+uint16_t fm_get_frequency_10khz(si470x_t *radio) {
     return radio->frequency;
 }
 
 void fm_set_frequency_blocking(si470x_t *radio, float frequency) {
+    fm_set_frequency_10khz_blocking(radio, fm_mhz_to_10khz(frequency));
+}
+
+void fm_set_frequency_10khz_blocking(si470x_t *radio, uint16_t frequency) {
     assert(fm_is_powered_up(radio));
     assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->frequency == frequency) {
         return;
     }
-    fm_set_frequency_async(radio, frequency);
+    fm_set_frequency_10khz_async(radio, frequency);
     fm_async_progress_t progress;
     do {
-        sleep_ms(TUNE_POLL_INTERVAL_MS);
+        fm_async_sleep_until_resume(radio);
         progress = fm_async_task_tick(radio);
     } while (!progress.done);
 }
 
 static fm_async_progress_t fm_set_frequency_async_task(si470x_t *radio, bool cancel) {
     assert(radio->async.task == &fm_set_frequency_async_task);
-    assert(radio->async.state == 1);
 
-    i2c_inst_t *i2c_inst = radio->i2c_inst;
     uint16_t *regs = radio->regs;
-    int result = 0;
     if (cancel) {
-        result = -1;
-    } else {
-        fm_read_registers_up_to(i2c_inst, regs, STATUSRSSI);
+        // clear tune bit
+        fm_set_bit(regs[CHANNEL], TUNE, false);
+        fm_write_registers_up_to(radio, CHANNEL);
+        while (!fm_poll_stc_cleared(radio)) {
+            tight_loop_contents();
+        }
+        return (fm_async_progress_t){.done = true, -1};
+    }
+
+    if (radio->async.state == 1) {
+        // tuning
+        if (radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_stc_pending)) {
+            radio->async.resume_time = time_us_64() + IRQ_POLL_INTERVAL_MS * 1000;
+            return (fm_async_progress_t){.done = false};
+        }
+        if (!fm_poll_registers_up_to(radio, STATUSRSSI)) {
+            return (fm_async_progress_t){.done = false}; // DMA transfer pending
+        }
+        fm_stats_add(radio, stc_polls, 1);
         if (!fm_get_bit(regs[STATUSRSSI], STC)) {
-            radio->async.resume_time = time_us_64() + TUNE_POLL_INTERVAL_MS * 1000;
+            fm_async_backoff(radio, TUNE_POLL_INTERVAL_MS);
             return (fm_async_progress_t){.done = false};
         }
-    }
 
-    // clear tune bit
-    fm_set_bit(regs[CHANNEL], TUNE, false);
-    fm_write_registers_up_to(i2c_inst, regs, CHANNEL);
-    // wait until STC bit cleared; shouldn't take longer than 1.5ms
-    do {
-        fm_read_registers_up_to(i2c_inst, regs, STATUSRSSI);
-    } while (fm_get_bit(regs[STATUSRSSI], STC));
+        // clear tune bit
+        fm_set_bit(regs[CHANNEL], TUNE, false);
+        fm_start_write_registers_up_to(radio, CHANNEL);
+        radio->async.state = 2;
+    }
 
-    fm_read_registers_up_to(i2c_inst, regs, READCHAN);
-    uint16_t channel = fm_get_bits(regs[READCHAN], READCHAN);
-    radio->frequency = fm_channel_to_frequency(channel, fm_get_frequency_range(radio));
-    return (fm_async_progress_t){.done = true, result};
+    assert(radio->async.state == 2);
+    if (!fm_poll_stc_cleared(radio)) {
+        return (fm_async_progress_t){.done = false};
+    }
+    return (fm_async_progress_t){.done = true, 0};
 }
 
 void fm_set_frequency_async(si470x_t *radio, float frequency) {
+    fm_set_frequency_10khz_async(radio, fm_mhz_to_10khz(frequency));
+}
+
+void fm_set_frequency_10khz_async(si470x_t *radio, uint16_t frequency) {
+    fm_set_channel_async(radio, fm_frequency_to_channel(frequency, fm_get_frequency_range_10khz(radio)));
+}
+
+void fm_set_channel_blocking(si470x_t *radio, uint16_t channel) {
+    fm_set_channel_async(radio, channel);
+    fm_async_progress_t progress;
+    do {
+        fm_async_sleep_until_resume(radio);
+        progress = fm_async_task_tick(radio);
+    } while (!progress.done);
+}
+
+void fm_set_channel_async(si470x_t *radio, uint16_t channel) {
     assert(fm_is_powered_up(radio));
     assert(radio->async.task == NULL); // disallowed during async task
+    assert(channel <= fm_get_top_channel(fm_get_frequency_range_10khz(radio)));
 
-    uint16_t channel = fm_frequency_to_channel(frequency, fm_get_frequency_range(radio));
     uint16_t *regs = radio->regs;
+    radio->irq_stc_pending = false;
     // set channel and start tuning
     fm_set_bits(regs[CHANNEL], CHAN, channel);
     fm_set_bit(regs[CHANNEL], TUNE, true);
-    fm_write_registers_up_to(radio->i2c_inst, regs, CHANNEL);
+    fm_start_write_registers_up_to(radio, CHANNEL);
 
     radio->async.task = fm_set_frequency_async_task;
     radio->async.state = 1;
-    radio->async.resume_time = time_us_64() + TUNE_POLL_INTERVAL_MS * 1000;
+    fm_async_start_polling(radio, TUNE_MIN_POLL_INTERVAL_MS);
 }
 
 fm_seek_sensitivity_t fm_get_seek_sensitivity(si470x_t *radio) {
@@ -399,14 +959,15 @@ fm_seek_sensitivity_t fm_get_seek_sensitivity(si470x_t *radio) {
 
 void fm_set_seek_sensitivity(si470x_t *radio, fm_seek_sensitivity_t seek_sensitivity) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->seek_sensitivity == seek_sensitivity) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_seek_sensitivity_bits(regs, seek_sensitivity);
-    fm_write_registers_up_to(radio->i2c_inst, regs, SYSCONFIG3);
+    fm_mark_dirty(radio, SYSCONFIG2);
+    fm_mark_dirty(radio, SYSCONFIG3);
+    fm_flush_registers(radio);
     radio->seek_sensitivity = seek_sensitivity;
 }
 
@@ -416,7 +977,7 @@ bool fm_seek_blocking(si470x_t *radio, fm_seek_direction_t direction) {
     fm_seek_async(radio, direction);
     fm_async_progress_t progress;
     do {
-        sleep_ms(SEEK_POLL_INTERVAL_MS);
+        fm_async_sleep_until_resume(radio);
         progress = fm_async_task_tick(radio);
     } while (!progress.done);
     bool success = (progress.result == 0);
@@ -425,39 +986,48 @@ bool fm_seek_blocking(si470x_t *radio, fm_seek_direction_t direction) {
 
 static fm_async_progress_t fm_seek_async_task(si470x_t *radio, bool cancel) {
     assert(radio->async.task == &fm_seek_async_task);
-    assert(radio->async.state == 1);
 
-    i2c_inst_t *i2c_inst = radio->i2c_inst;
     uint16_t *regs = radio->regs;
-    int result = 0;
     if (cancel) {
-        result = -1;
-    } else {
-        fm_read_registers_up_to(i2c_inst, regs, READCHAN);
+        // clear seek bit
+        fm_set_bit(regs[POWERCFG], SEEK, false);
+        fm_write_registers_up_to(radio, POWERCFG);
+        while (!fm_poll_stc_cleared(radio)) {
+            tight_loop_contents();
+        }
+        return (fm_async_progress_t){.done = true, -1};
+    }
+
+    if (radio->async.state == 1) {
+        // seeking
+        if (radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_stc_pending)) {
+            radio->async.resume_time = time_us_64() + IRQ_POLL_INTERVAL_MS * 1000;
+            return (fm_async_progress_t){.done = false};
+        }
+        if (!fm_poll_registers_up_to(radio, READCHAN)) {
+            return (fm_async_progress_t){.done = false}; // DMA transfer pending
+        }
+        fm_stats_add(radio, stc_polls, 1);
         if (!fm_get_bit(regs[STATUSRSSI], STC)) {
             uint16_t channel = fm_get_bits(regs[READCHAN], READCHAN);
-            radio->frequency = fm_channel_to_frequency(channel, fm_get_frequency_range(radio));
-            radio->async.resume_time = time_us_64() + SEEK_POLL_INTERVAL_MS * 1000;
+            radio->frequency = fm_channel_to_frequency(channel, fm_get_frequency_range_10khz(radio));
+            fm_async_backoff(radio, SEEK_POLL_INTERVAL_MS);
             return (fm_async_progress_t){.done = false};
         }
 
         // seek done, check seek-failed / band-limit flag
-        if (fm_get_bit(regs[STATUSRSSI], SFBL)) {
-            result = -1;
-        }
-    }
+        radio->async.state = fm_get_bit(regs[STATUSRSSI], SFBL) ? 3 : 2;
 
-    // clear seek bit
-    fm_set_bit(regs[POWERCFG], SEEK, false);
-    fm_write_registers_up_to(i2c_inst, regs, POWERCFG);
-    // wait until STC bit cleared; shouldn't take longer than 1.5ms
-    do {
-        fm_read_registers_up_to(i2c_inst, regs, STATUSRSSI);
-    } while (fm_get_bit(regs[STATUSRSSI], STC));
+        // clear seek bit
+        fm_set_bit(regs[POWERCFG], SEEK, false);
+        fm_start_write_registers_up_to(radio, POWERCFG);
+    }
 
-    fm_read_registers_up_to(i2c_inst, regs, READCHAN);
-    uint16_t channel = fm_get_bits(regs[READCHAN], READCHAN);
-    radio->frequency = fm_channel_to_frequency(channel, fm_get_frequency_range(radio));
+    assert(radio->async.state == 2 || radio->async.state == 3);
+    if (!fm_poll_stc_cleared(radio)) {
+        return (fm_async_progress_t){.done = false};
+    }
+    int result = (radio->async.state == 2) ? 0 : -1;
     return (fm_async_progress_t){.done = true, result};
 }
 
@@ -466,14 +1036,176 @@ void fm_seek_async(si470x_t *radio, fm_seek_direction_t direction) {
     assert(radio->async.task == NULL); // disallowed during async task
 
     uint16_t *regs = radio->regs;
+    radio->irq_stc_pending = false;
     fm_set_bit(regs[POWERCFG], SKMODE, false); // wrap mode
     fm_set_bit(regs[POWERCFG], SEEKUP, direction == FM_SEEK_UP);
     fm_set_bit(regs[POWERCFG], SEEK, true); // start seek
-    fm_write_registers_up_to(radio->i2c_inst, regs, POWERCFG);
+    fm_start_write_registers_up_to(radio, POWERCFG);
 
     radio->async.task = fm_seek_async_task;
     radio->async.state = 1;
-    radio->async.resume_time = time_us_64() + SEEK_POLL_INTERVAL_MS * 1000;
+    fm_async_start_polling(radio, SEEK_MIN_POLL_INTERVAL_MS);
+}
+
+size_t fm_scan_blocking(si470x_t *radio, fm_scan_config_t config, fm_scan_station_t *stations, size_t capacity) {
+    assert(radio->async.task == NULL); // disallowed during async task
+
+    fm_scan_async(radio, config, stations, capacity);
+    fm_async_progress_t progress;
+    do {
+        fm_async_sleep_until_resume(radio);
+        progress = fm_async_task_tick(radio);
+    } while (!progress.done);
+    return (size_t)progress.result;
+}
+
+static void fm_scan_start_step(si470x_t *radio) {
+    fm_scan_state_t *scan = &radio->scan;
+    uint16_t *regs = radio->regs;
+    radio->irq_stc_pending = false;
+    if (scan->seek_started) {
+        // seek from the current station, stop at band limit
+        fm_set_bit(regs[POWERCFG], SKMODE, true);
+        fm_set_bit(regs[POWERCFG], SEEKUP, true);
+        fm_set_bit(regs[POWERCFG], SEEK, true);
+        fm_start_write_registers_up_to(radio, POWERCFG);
+    } else {
+        // tune the next channel, also used to start seeking from the bottom of the band
+        fm_set_bits(regs[CHANNEL], CHAN, scan->channel);
+        fm_set_bit(regs[CHANNEL], TUNE, true);
+        fm_start_write_registers_up_to(radio, CHANNEL);
+    }
+    radio->async.state = 2;
+    fm_async_start_polling(radio, SCAN_POLL_INTERVAL_MS);
+}
+
+static fm_async_progress_t fm_scan_async_task(si470x_t *radio, bool cancel) {
+    assert(radio->async.task == &fm_scan_async_task);
+
+    fm_scan_state_t *scan = &radio->scan;
+    uint16_t *regs = radio->regs;
+    if (cancel) {
+        fm_set_bit(regs[CHANNEL], TUNE, false);
+        fm_set_bit(regs[POWERCFG], SEEK, false);
+        fm_write_registers_up_to(radio, CHANNEL);
+        while (!fm_poll_stc_cleared(radio)) {
+            tight_loop_contents();
+        }
+        return (fm_async_progress_t){.done = true, -1};
+    }
+
+    switch (radio->async.state) {
+    case 2: // wait for tune / seek
+        if (radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_stc_pending)) {
+            radio->async.resume_time = time_us_64() + IRQ_POLL_INTERVAL_MS * 1000;
+            return (fm_async_progress_t){.done = false};
+        }
+        if (!fm_poll_registers_up_to(radio, READCHAN)) {
+            return (fm_async_progress_t){.done = false}; // DMA transfer pending
+        }
+        fm_stats_add(radio, stc_polls, 1);
+        if (!fm_get_bit(regs[STATUSRSSI], STC)) {
+            fm_async_backoff(radio, SCAN_POLL_INTERVAL_MS);
+            return (fm_async_progress_t){.done = false};
+        }
+        scan->current = (fm_scan_station_t){
+            .rssi = fm_get_bits(regs[STATUSRSSI], RSSI),
+            .stereo = fm_get_bit(regs[STATUSRSSI], ST),
+        };
+        bool valid = (scan->current.rssi >= scan->config.min_rssi);
+        if (scan->config.mode == FM_SCAN_SEEK) {
+            // SFBL must be checked before clearing the seek bit; a failed seek has reached the band limit
+            scan->band_limit = scan->seek_started && fm_get_bit(regs[STATUSRSSI], SFBL);
+            // the seek doesn't evaluate its starting channel, judge the initial tune to the bottom
+            // of the band by RSSI like a sweep does
+            valid = valid && !scan->band_limit;
+        }
+
+        fm_set_bit(regs[CHANNEL], TUNE, false);
+        fm_set_bit(regs[POWERCFG], SEEK, false);
+        fm_start_write_registers_up_to(radio, CHANNEL);
+        radio->async.state = valid ? 3 : 4;
+        // fall through
+
+    case 3: // valid station, wait until STC bit cleared
+    case 4: // skipped channel, wait until STC bit cleared
+        if (!fm_poll_stc_cleared(radio)) {
+            return (fm_async_progress_t){.done = false};
+        }
+        scan->channel = fm_get_bits(regs[READCHAN], READCHAN);
+        scan->current.frequency = radio->frequency;
+        if (radio->async.state == 4) {
+            break; // next step
+        }
+        if (scan->config.dwell_ms == 0 || !fm_is_rds_supported(radio)) {
+            scan->stations[scan->count++] = scan->current;
+            break; // next step
+        }
+        radio->irq_rds_pending = false;
+        scan->dwell_end_time = time_us_64() + scan->config.dwell_ms * 1000;
+        radio->async.state = 5;
+        return (fm_async_progress_t){.done = false};
+
+    default: // 5 - wait for RDS PI code
+        if (!(radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_rds_pending))) {
+            if (!fm_poll_registers_up_to(radio, RDSA)) {
+                return (fm_async_progress_t){.done = false}; // DMA transfer pending
+            }
+            if (fm_get_bit(regs[STATUSRSSI], RDSR) && fm_get_bits(regs[STATUSRSSI], BLERA) < 3) {
+                scan->current.pi = regs[RDSA];
+            }
+        }
+        if (scan->current.pi == 0 && time_us_64() < scan->dwell_end_time) {
+            radio->async.resume_time = time_us_64() + SCAN_RDS_POLL_INTERVAL_MS * 1000;
+            return (fm_async_progress_t){.done = false};
+        }
+        scan->stations[scan->count++] = scan->current;
+        break; // next step
+    }
+
+    // next step
+    if (scan->config.mode == FM_SCAN_SWEEP) {
+        fm_frequency_range_10khz_t range = fm_get_frequency_range_10khz(radio);
+        scan->band_limit = (scan->channel >= fm_get_top_channel(range));
+    }
+    if (scan->band_limit || scan->count == scan->capacity) {
+        return (fm_async_progress_t){.done = true, (int)scan->count};
+    }
+    if (scan->config.mode == FM_SCAN_SWEEP) {
+        scan->channel++;
+    } else {
+        scan->seek_started = true;
+    }
+    fm_scan_start_step(radio);
+    return (fm_async_progress_t){.done = false};
+}
+
+void fm_scan_async(si470x_t *radio, fm_scan_config_t config, fm_scan_station_t *stations, size_t capacity) {
+    assert(fm_is_powered_up(radio));
+    assert(radio->async.task == NULL); // disallowed during async task
+    assert(capacity != 0);
+
+    radio->scan = (fm_scan_state_t){
+        .config = config,
+        .stations = stations,
+        .capacity = capacity,
+    };
+    radio->async.task = fm_scan_async_task;
+    fm_scan_start_step(radio);
+}
+
+void fm_begin_update(si470x_t *radio) {
+    assert(radio->update_depth < UINT8_MAX);
+
+    radio->update_depth++;
+}
+
+void fm_commit_update(si470x_t *radio) {
+    assert(radio->update_depth != 0); // must match fm_begin_update()
+
+    if (--radio->update_depth == 0 && fm_is_powered_up(radio)) {
+        fm_flush_registers(radio);
+    }
 }
 
 bool fm_get_mute(si470x_t *radio) {
@@ -482,14 +1214,14 @@ bool fm_get_mute(si470x_t *radio) {
 
 void fm_set_mute(si470x_t *radio, bool mute) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->mute == mute) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_bit(regs[POWERCFG], DMUTE, !mute);
-    fm_write_registers_up_to(radio->i2c_inst, regs, POWERCFG);
+    fm_mark_dirty(radio, POWERCFG);
+    fm_flush_registers(radio);
     radio->mute = mute;
 }
 
@@ -499,14 +1231,14 @@ bool fm_get_softmute(si470x_t *radio) {
 
 void fm_set_softmute(si470x_t *radio, bool softmute) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->softmute == softmute) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_bit(regs[POWERCFG], DSMUTE, !softmute);
-    fm_write_registers_up_to(radio->i2c_inst, regs, POWERCFG);
+    fm_mark_dirty(radio, POWERCFG);
+    fm_flush_registers(radio);
     radio->softmute = softmute;
 }
 
@@ -516,14 +1248,14 @@ fm_softmute_rate_t fm_get_softmute_rate(si470x_t *radio) {
 
 void fm_set_softmute_rate(si470x_t *radio, fm_softmute_rate_t softmute_rate) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->softmute_rate == softmute_rate) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_bits(regs[SYSCONFIG3], SMUTER, softmute_rate);
-    fm_write_registers_up_to(radio->i2c_inst, regs, SYSCONFIG3);
+    fm_mark_dirty(radio, SYSCONFIG3);
+    fm_flush_registers(radio);
     radio->softmute_rate = softmute_rate;
 }
 
@@ -533,14 +1265,14 @@ fm_softmute_attenuation_t fm_get_softmute_attenuation(si470x_t *radio) {
 
 void fm_set_softmute_attenuation(si470x_t *radio, fm_softmute_attenuation_t softmute_attenuation) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->softmute_attenuation == softmute_attenuation) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_bits(regs[SYSCONFIG3], SMUTEA, softmute_attenuation);
-    fm_write_registers_up_to(radio->i2c_inst, regs, SYSCONFIG3);
+    fm_mark_dirty(radio, SYSCONFIG3);
+    fm_flush_registers(radio);
     radio->softmute_attenuation = softmute_attenuation;
 }
 
@@ -550,17 +1282,34 @@ bool fm_get_mono(si470x_t *radio) {
 
 void fm_set_mono(si470x_t *radio, bool mono) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     if (radio->mono == mono) {
         return;
     }
     uint16_t *regs = radio->regs;
     fm_set_bit(regs[POWERCFG], MONO, mono);
-    fm_write_registers_up_to(radio->i2c_inst, regs, POWERCFG);
+    fm_mark_dirty(radio, POWERCFG);
+    fm_flush_registers(radio);
     radio->mono = mono;
 }
 
+bool fm_get_rds_verbose(si470x_t *radio) {
+    return radio->rds_verbose;
+}
+
+void fm_set_rds_verbose(si470x_t *radio, bool rds_verbose) {
+    assert(fm_is_powered_up(radio));
+
+    if (radio->rds_verbose == rds_verbose) {
+        return;
+    }
+    uint16_t *regs = radio->regs;
+    fm_set_bit(regs[POWERCFG], RDSM, rds_verbose);
+    fm_mark_dirty(radio, POWERCFG);
+    fm_flush_registers(radio);
+    radio->rds_verbose = rds_verbose;
+}
+
 uint8_t fm_get_volume(si470x_t *radio) {
     return radio->volume;
 }
@@ -571,16 +1320,21 @@ bool fm_get_volext(si470x_t *radio) {
 
 void fm_set_volume(si470x_t *radio, uint8_t volume, bool volext) {
     assert(fm_is_powered_up(radio));
-    assert(radio->async.task == NULL); // disallowed during async task
 
     volume = MIN(volume, FM_MAX_VOLUME);
     if (radio->volume == volume && radio->volext == volext) {
         return;
     }
     uint16_t *regs = radio->regs;
-    fm_set_bits(regs[SYSCONFIG2], VOLUME, volume);
-    fm_set_bit(regs[SYSCONFIG3], VOLEXT, volext);
-    fm_write_registers_up_to(radio->i2c_inst, regs, SYSCONFIG3);
+    if (radio->volume != volume) {
+        fm_set_bits(regs[SYSCONFIG2], VOLUME, volume);
+        fm_mark_dirty(radio, SYSCONFIG2);
+    }
+    if (radio->volext != volext) {
+        fm_set_bit(regs[SYSCONFIG3], VOLEXT, volext);
+        fm_mark_dirty(radio, SYSCONFIG3);
+    }
+    fm_flush_registers(radio);
     radio->volume = volume;
     radio->volext = volext;
 }
@@ -589,7 +1343,7 @@ uint8_t fm_get_rssi(si470x_t *radio) {
     assert(fm_is_powered_up(radio));
 
     uint16_t *regs = radio->regs;
-    fm_read_registers_up_to(radio->i2c_inst, regs, STATUSRSSI);
+    fm_read_status_up_to(radio, STATUSRSSI);
     uint8_t rssi = (uint8_t)fm_get_bits(regs[STATUSRSSI], RSSI);
     return rssi;
 }
@@ -598,7 +1352,7 @@ bool fm_get_stereo_indicator(si470x_t *radio) {
     assert(fm_is_powered_up(radio));
 
     uint16_t *regs = radio->regs;
-    fm_read_registers_up_to(radio->i2c_inst, regs, STATUSRSSI);
+    fm_read_status_up_to(radio, STATUSRSSI);
     bool stereo = fm_get_bit(regs[STATUSRSSI], ST);
     return stereo;
 }
@@ -608,20 +1362,237 @@ bool fm_is_rds_supported(si470x_t *radio) {
     return dev == DEV_SI4703;
 }
 
+static void fm_count_rds_group(si470x_t *radio) {
+#if FM_SI470X_STATS_ENABLE
+    uint8_t bler[4];
+    fm_get_rds_block_errors(radio, bler);
+    fm_stats_add(radio, rds_groups, 1);
+    bool corrupted = false;
+    for (size_t i = 0; i < 4; i++) {
+        if (bler[i] == 3) {
+            fm_stats_add(radio, rds_block_errors[i], 1);
+            corrupted = true;
+        }
+    }
+    if (corrupted) {
+        fm_stats_add(radio, rds_groups_corrupted, 1);
+    }
+#else
+    (void)radio;
+#endif
+}
+
 bool fm_read_rds_group(si470x_t *radio, uint16_t *blocks) {
     assert(fm_is_powered_up(radio));
     assert(fm_is_rds_supported(radio));
 
+    if (radio->irq_enabled && !fm_consume_irq(&radio->irq_rds_pending)) {
+        return false; // no interrupt since last read
+    }
     uint16_t *regs = radio->regs;
-    fm_read_registers_up_to(radio->i2c_inst, regs, RDSD);
+    if (radio->irq_enabled) {
+        fm_read_registers_up_to(radio, RDSD); // just signaled, cache is stale
+    } else {
+        fm_read_status_up_to(radio, RDSD);
+    }
     bool rdsr = fm_get_bit(regs[STATUSRSSI], RDSR);
-    if (!rdsr) {
+    if (!rdsr || radio->status_rds_consumed) {
         return false; // not ready
     }
     memcpy(blocks, regs + RDSA, 4 * sizeof(uint16_t));
+    radio->status_rds_consumed = true;
+    fm_count_rds_group(radio);
+    return true;
+}
+
+static bool fm_read_rds_group_direct(si470x_t *radio, uint16_t *blocks) {
+    // STATUSRSSI and READCHAN go to the mirror, RDSA..RDSD straight to the caller
+    uint8_t buf[12];
+    if (!fm_read_raw(radio, buf, fm_read_count_up_to(RDSD))) {
+        return false;
+    }
+    fm_unpack_registers(radio->regs, buf, 2);
+    radio->status_read_time = 0; // mirror holds old blocks, don't serve them as a fresh status
+    if (!fm_get_bit(radio->regs[STATUSRSSI], RDSR)) {
+        return false; // not ready
+    }
+    for (size_t i = 0; i < 4; i++) {
+        blocks[i] = (buf[4 + 2 * i] << 8) | buf[5 + 2 * i];
+    }
+    return true;
+}
+
+bool fm_read_rds_group_with_errors(si470x_t *radio, uint16_t *blocks, uint8_t *bler) {
+    assert(fm_is_powered_up(radio));
+    assert(fm_is_rds_supported(radio));
+
+    if (radio->irq_enabled && !fm_consume_irq(&radio->irq_rds_pending)) {
+        return false; // no interrupt since last read
+    }
+    bool cached = !radio->irq_enabled && radio->status_max_age_us != 0 && radio->status_read_time != 0
+        && time_us_64() - radio->status_read_time <= radio->status_max_age_us;
+    if (cached) {
+        uint16_t *regs = radio->regs;
+        if (!fm_get_bit(regs[STATUSRSSI], RDSR) || radio->status_rds_consumed) {
+            return false; // not ready
+        }
+        memcpy(blocks, regs + RDSA, 4 * sizeof(uint16_t));
+        radio->status_rds_consumed = true;
+    } else if (!fm_read_rds_group_direct(radio, blocks)) {
+        return false;
+    }
+    fm_get_rds_block_errors(radio, bler);
+    fm_count_rds_group(radio);
     return true;
 }
 
+static fm_async_progress_t fm_read_rds_group_async_task(si470x_t *radio, bool cancel) {
+    assert(radio->async.task == &fm_read_rds_group_async_task);
+    assert(radio->async.state == 1);
+
+    if (cancel) {
+        fm_dma_wait(radio);
+        return (fm_async_progress_t){.done = true, -1};
+    }
+    if (radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_rds_pending)) {
+        return (fm_async_progress_t){.done = true, 0}; // no interrupt since last read
+    }
+    if (!fm_poll_registers_up_to(radio, RDSD)) {
+        return (fm_async_progress_t){.done = false}; // DMA transfer pending
+    }
+    uint16_t *regs = radio->regs;
+    bool rdsr = fm_get_bit(regs[STATUSRSSI], RDSR);
+    if (!rdsr) {
+        return (fm_async_progress_t){.done = true, 0}; // not ready
+    }
+    memcpy(radio->async.output, regs + RDSA, 4 * sizeof(uint16_t));
+    radio->status_rds_consumed = true;
+    fm_count_rds_group(radio);
+    return (fm_async_progress_t){.done = true, 1};
+}
+
+void fm_read_rds_group_async(si470x_t *radio, uint16_t *blocks) {
+    assert(fm_is_powered_up(radio));
+    assert(fm_is_rds_supported(radio));
+    assert(radio->async.task == NULL); // disallowed during async task
+
+    radio->async.task = fm_read_rds_group_async_task;
+    radio->async.state = 1;
+    radio->async.resume_time = 0;
+    radio->async.output = blocks;
+}
+
+void fm_set_status_max_age(si470x_t *radio, uint32_t max_age_us) {
+    radio->status_max_age_us = max_age_us;
+}
+
+void fm_get_status(si470x_t *radio, fm_status_t *status) {
+    assert(fm_is_powered_up(radio));
+
+    uint16_t *regs = radio->regs;
+    fm_read_status_up_to(radio, RDSD);
+    status->rssi = (uint8_t)fm_get_bits(regs[STATUSRSSI], RSSI);
+    status->stereo = fm_get_bit(regs[STATUSRSSI], ST);
+    status->rds_ready = fm_get_bit(regs[STATUSRSSI], RDSR);
+    status->rds_synced = fm_get_bit(regs[STATUSRSSI], RDSS);
+    fm_get_rds_block_errors(radio, status->bler);
+    memcpy(status->rds_blocks, regs + RDSA, 4 * sizeof(uint16_t));
+}
+
+void fm_get_rds_block_errors(si470x_t *radio, uint8_t *bler) {
+    uint16_t *regs = radio->regs;
+    bler[0] = fm_get_bits(regs[STATUSRSSI], BLERA);
+    bler[1] = fm_get_bits(regs[READCHAN], BLERB);
+    bler[2] = fm_get_bits(regs[READCHAN], BLERC);
+    bler[3] = fm_get_bits(regs[READCHAN], BLERD);
+}
+
+static fm_async_progress_t fm_wait_rds_pi_async_task(si470x_t *radio, bool cancel) {
+    assert(radio->async.task == &fm_wait_rds_pi_async_task);
+
+    if (cancel) {
+        fm_dma_wait(radio);
+        return (fm_async_progress_t){.done = true, -1};
+    }
+    if (!(radio->irq_enabled && !radio->dma.busy && !fm_consume_irq(&radio->irq_rds_pending))) {
+        if (!fm_poll_registers_up_to(radio, RDSA)) {
+            return (fm_async_progress_t){.done = false}; // DMA transfer pending
+        }
+        // the group isn't marked as consumed, so it still reaches fm_read_rds_group()
+        uint16_t *regs = radio->regs;
+        if (fm_get_bit(regs[STATUSRSSI], RDSR) && fm_get_bits(regs[STATUSRSSI], BLERA) < 3) {
+            return (fm_async_progress_t){.done = true, regs[RDSA]};
+        }
+    }
+    uint64_t now = time_us_64();
+    if (radio->async.end_time <= now) {
+        return (fm_async_progress_t){.done = true, -1}; // timed out
+    }
+    radio->async.resume_time = MIN(now + SCAN_RDS_POLL_INTERVAL_MS * 1000, radio->async.end_time);
+    return (fm_async_progress_t){.done = false};
+}
+
+static fm_async_progress_t fm_delay_async_task(si470x_t *radio, bool cancel) {
+    assert(radio->async.task == &fm_delay_async_task);
+
+    // only ticked once resume time has passed
+    return (fm_async_progress_t){.done = true, cancel ? -1 : 0};
+}
+
+static bool fm_async_start_op(si470x_t *radio, const fm_async_op_t *op) {
+    // returns false for operations that complete immediately
+    switch (op->type) {
+    case FM_ASYNC_OP_TUNE:
+        fm_set_frequency_10khz_async(radio, op->frequency);
+        return true;
+    case FM_ASYNC_OP_SEEK:
+        fm_seek_async(radio, op->direction);
+        return true;
+    case FM_ASYNC_OP_WAIT_RDS_PI:
+        radio->irq_rds_pending = false;
+        radio->async.task = fm_wait_rds_pi_async_task;
+        radio->async.resume_time = 0;
+        radio->async.end_time = time_us_64() + op->timeout_ms * 1000;
+        return true;
+    case FM_ASYNC_OP_DELAY:
+        radio->async.task = fm_delay_async_task;
+        radio->async.resume_time = time_us_64() + op->timeout_ms * 1000;
+        return true;
+    case FM_ASYNC_OP_SET_MUTE:
+        fm_set_mute(radio, op->mute);
+        return false;
+    default: // FM_ASYNC_OP_SET_VOLUME
+        fm_set_volume(radio, op->volume, op->volext);
+        return false;
+    }
+}
+
+static bool fm_async_start_next(si470x_t *radio) {
+    // start queued operations until one keeps running, returns false once the queue has drained
+    fm_async_queue_t *queue = &radio->queue;
+    while (queue->count != 0) {
+        fm_async_op_t op = queue->ops[queue->head];
+        queue->head = (queue->head + 1) % FM_ASYNC_QUEUE_CAPACITY;
+        queue->count--;
+        if (fm_async_start_op(radio, &op)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void fm_async_flush_registers(si470x_t *radio) {
+    // Write setter changes held back while the task is running. Writes always start at POWERCFG,
+    // so a running tune / seek gets its TUNE / SEEK bit written again as 1. That doesn't start
+    // a new operation: the datasheet requires the bit to be set low (and STC to clear) before
+    // the next tune or seek can begin. Skipped while powering up.
+    if (radio->update_depth != 0 || radio->dirty_regs == 0 || radio->dma.busy
+        || radio->async.task == &fm_power_up_async_task) {
+        return;
+    }
+    fm_start_write_registers_up_to(radio, fm_last_dirty_register(radio));
+}
+
 fm_async_progress_t fm_async_task_tick(si470x_t *radio) {
     assert(radio->async.task != NULL); // must have an async task running
 
@@ -630,15 +1601,66 @@ fm_async_progress_t fm_async_task_tick(si470x_t *radio) {
         return (fm_async_progress_t){.done = false};
     }
     fm_async_progress_t progress = radio->async.task(radio, false /* cancel */);
-    if (progress.done) {
-        radio->async = (fm_async_state_t){};
+    if (!progress.done) {
+        fm_async_flush_registers(radio);
+        return progress;
+    }
+    fm_async_callback_t callback = radio->async.callback;
+    void *user_data = radio->async.user_data;
+    radio->async = (fm_async_state_t){};
+    fm_flush_registers(radio);
+    if (progress.result >= 0 && fm_async_start_next(radio)) {
+        // hand over to the next operation, keeping the callback
+        radio->async.callback = callback;
+        radio->async.user_data = user_data;
+        return (fm_async_progress_t){.done = false};
+    }
+    radio->queue.count = 0; // a failed operation discards the rest
+    if (callback != NULL) {
+        callback(radio, progress.result, user_data);
     }
     return progress;
 }
 
+void fm_async_task_set_callback(si470x_t *radio, fm_async_callback_t callback, void *user_data) {
+    assert(radio->async.task != NULL); // must have an async task running
+
+    radio->async.callback = callback;
+    radio->async.user_data = user_data;
+}
+
 void fm_async_task_cancel(si470x_t *radio) {
     assert(radio->async.task != NULL); // must have an async task running
 
     radio->async.task(radio, true /* cancel */);
     radio->async = (fm_async_state_t){};
+    radio->queue.count = 0;
+    fm_flush_registers(radio);
+}
+
+bool fm_async_enqueue(si470x_t *radio, fm_async_op_t op) {
+    assert(fm_is_powered_up(radio));
+    assert(op.type != FM_ASYNC_OP_WAIT_RDS_PI || fm_is_rds_supported(radio));
+
+    if (radio->async.task == NULL) {
+        fm_async_start_op(radio, &op);
+        return true;
+    }
+    fm_async_queue_t *queue = &radio->queue;
+    if (queue->count == FM_ASYNC_QUEUE_CAPACITY) {
+        return false;
+    }
+    queue->ops[(queue->head + queue->count) % FM_ASYNC_QUEUE_CAPACITY] = op;
+    queue->count++;
+    return true;
+}
+
+#if FM_SI470X_STATS_ENABLE
+void fm_get_stats(si470x_t *radio, fm_stats_t *stats) {
+    *stats = radio->stats;
 }
+
+void fm_reset_stats(si470x_t *radio) {
+    radio->stats = (fm_stats_t){};
+}
+#endif
@@ -8,6 +8,7 @@
 #define _SI470X_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -23,6 +24,20 @@ extern "C" {
  * - AN230 - Si4700/01/02/03 Programming Guide (Rev. 0.9 6/09)
  */
 
+/**
+ * \brief Enable diagnostic counters, see fm_get_stats().
+ */
+#ifndef FM_SI470X_STATS_ENABLE
+#define FM_SI470X_STATS_ENABLE 0
+#endif
+
+/**
+ * \brief Number of operations that may wait behind the current async task, see fm_async_enqueue().
+ */
+#ifndef FM_ASYNC_QUEUE_CAPACITY
+#define FM_ASYNC_QUEUE_CAPACITY 4
+#endif
+
 /**
  * \brief Maximum volume.
  */
@@ -95,6 +110,18 @@ typedef struct fm_frequency_range_t
     float spacing;
 } fm_frequency_range_t;
 
+/**
+ * \brief Frequency range in 10 kHz units corresponding to an fm_band_t.
+ * 
+ * For example, 87.5 MHz is represented as 8750.
+ */
+typedef struct fm_frequency_range_10khz_t
+{
+    uint16_t bottom;
+    uint16_t top;
+    uint16_t spacing;
+} fm_frequency_range_10khz_t;
+
 /**
  * \brief Sensitivity settings used during seek.
  * 
@@ -117,6 +144,36 @@ typedef enum fm_seek_direction_t
     FM_SEEK_UP,
 } fm_seek_direction_t;
 
+/**
+ * \brief Band scan strategy.
+ */
+typedef enum fm_scan_mode_t
+{
+    FM_SCAN_SEEK, /**< Seek from station to station across the band, using the seek sensitivity. The bottom channel is checked against min_rssi. */
+    FM_SCAN_SWEEP, /**< Tune every channel in the band. */
+} fm_scan_mode_t;
+
+/**
+ * \brief Band scan settings.
+ */
+typedef struct fm_scan_config_t
+{
+    fm_scan_mode_t mode;
+    uint8_t min_rssi; /**< Channels with lower RSSI are skipped. */
+    uint16_t dwell_ms; /**< How long to wait for an RDS PI code on each station. 0 to skip RDS. */
+} fm_scan_config_t;
+
+/**
+ * \brief Station found by a band scan.
+ */
+typedef struct fm_scan_station_t
+{
+    uint16_t frequency; /**< Frequency in 10 kHz units. */
+    uint16_t pi; /**< RDS program identification, 0 if not received. */
+    uint8_t rssi; /**< Signal strength in dBµV. */
+    bool stereo; /**< Stereo indicator. */
+} fm_scan_station_t;
+
 /**
  * \brief Volume reduction when not tuned to a station, in dB. 
  */
@@ -163,46 +220,193 @@ typedef struct fm_async_progress_t
 
 struct si470x_t;
 
+/**
+ * \brief Called when an asynchronous task completes.
+ * 
+ * @param radio Radio handle.
+ * @param result Task return value. Negative on error.
+ * @param user_data User data passed to fm_async_task_set_callback().
+ */
+typedef void (*fm_async_callback_t)(struct si470x_t *radio, int result, void *user_data);
+
 // private
 typedef fm_async_progress_t (*fm_async_task_t)(struct si470x_t *radio, bool cancel);
 
+/**
+ * \brief Operations that can be queued, see fm_async_enqueue().
+ */
+typedef enum fm_async_op_type_t
+{
+    FM_ASYNC_OP_TUNE, /**< Tune to frequency, see fm_set_frequency_10khz_async(). */
+    FM_ASYNC_OP_SEEK, /**< Seek in direction, see fm_seek_async(). Fails if no station was found. */
+    FM_ASYNC_OP_WAIT_RDS_PI, /**< Wait up to timeout_ms for an RDS group with intact PI. Result is the PI code. */
+    FM_ASYNC_OP_DELAY, /**< Wait timeout_ms. */
+    FM_ASYNC_OP_SET_MUTE, /**< Set mute, see fm_set_mute(). */
+    FM_ASYNC_OP_SET_VOLUME, /**< Set volume and volext, see fm_set_volume(). */
+} fm_async_op_type_t;
+
+/**
+ * \brief Queued operation, see fm_async_enqueue().
+ */
+typedef struct fm_async_op_t
+{
+    fm_async_op_type_t type;
+    union
+    {
+        uint16_t frequency; /**< FM_ASYNC_OP_TUNE, in 10 kHz units. */
+        fm_seek_direction_t direction; /**< FM_ASYNC_OP_SEEK */
+        uint16_t timeout_ms; /**< FM_ASYNC_OP_WAIT_RDS_PI, FM_ASYNC_OP_DELAY */
+        bool mute; /**< FM_ASYNC_OP_SET_MUTE */
+        uint8_t volume; /**< FM_ASYNC_OP_SET_VOLUME */
+    };
+    bool volext; /**< FM_ASYNC_OP_SET_VOLUME */
+} fm_async_op_t;
+
+/**
+ * \brief Register transport, see fm_set_transport().
+ */
+typedef struct fm_transport_t
+{
+    /** Take over SDIO and SCLK, after bus mode selection. Called on every cold power up. */
+    void (*init_pins)(void *context, uint8_t sdio_pin, uint8_t sclk_pin, bool enable_pull_ups);
+    /** Read len bytes from the 7-bit address addr. Returns false if not acknowledged. */
+    bool (*read)(void *context, uint8_t addr, uint8_t *dst, size_t len);
+    /** Write len bytes to the 7-bit address addr. Returns false if not acknowledged. */
+    bool (*write)(void *context, uint8_t addr, const uint8_t *src, size_t len);
+} fm_transport_t;
+
+/**
+ * \brief Function called before each register transfer, see fm_set_bus_select().
+ */
+typedef void (*fm_bus_select_t)(struct si470x_t *radio, void *user_data);
+
 // private
 typedef struct fm_async_state_t
 {
     fm_async_task_t task;
     uint8_t state;
     uint64_t resume_time;
+    uint16_t poll_interval_ms; // next polling interval, grows while waiting
+    uint64_t end_time; // deadline of waiting tasks
+    void *output;
+    fm_async_callback_t callback;
+    void *user_data;
 } fm_async_state_t;
 
+// private
+typedef struct fm_async_queue_t
+{
+    fm_async_op_t ops[FM_ASYNC_QUEUE_CAPACITY];
+    uint8_t head;
+    uint8_t count;
+} fm_async_queue_t;
+
+/**
+ * \brief Signal and RDS status, see fm_get_status().
+ */
+typedef struct fm_status_t
+{
+    uint8_t rssi; /**< Received signal strength, up to 75dBµV. */
+    bool stereo; /**< Stereo indicator. */
+    bool rds_ready; /**< RDS group available in rds_blocks. Always false on Si4702. */
+    bool rds_synced; /**< RDS decoder synchronized. Only reported in verbose mode, see fm_set_rds_verbose(). */
+    uint8_t bler[4]; /**< Error levels for RDS blocks A-D, see fm_get_rds_block_errors(). */
+    uint16_t rds_blocks[4]; /**< RDS blocks A-D. */
+} fm_status_t;
+
+#if FM_SI470X_STATS_ENABLE
+/**
+ * \brief Diagnostic counters, accumulated since fm_init() or fm_reset_stats().
+ */
+typedef struct fm_stats_t
+{
+    uint32_t i2c_transfers; /**< Register reads and writes, including failed ones. */
+    uint32_t i2c_failures; /**< Transfers not acknowledged by the chip. */
+    uint32_t i2c_bytes_read; /**< Register data read, excluding I2C addressing. */
+    uint32_t i2c_bytes_written; /**< Register data written, excluding I2C addressing. */
+    uint32_t stc_polls; /**< Status reads while waiting for tune / seek to complete. */
+    uint32_t rds_groups; /**< RDS groups received. */
+    uint32_t rds_groups_corrupted; /**< RDS groups with at least one uncorrectable block. */
+    uint32_t rds_block_errors[4]; /**< Uncorrectable blocks, by position A-D. */
+} fm_stats_t;
+#endif
+
+// private
+typedef struct fm_dma_state_t
+{
+    int8_t tx_channel; // -1 if DMA is disabled
+    int8_t rx_channel;
+    bool busy;
+    bool read;
+    uint8_t reg_count;
+    uint16_t written_regs; // dirty registers sent by the pending write, restored if it fails
+    uint16_t cmd_buf[32];
+    uint8_t data_buf[32];
+} fm_dma_state_t;
+
+// private
+typedef struct fm_scan_state_t
+{
+    fm_scan_config_t config;
+    fm_scan_station_t *stations;
+    size_t capacity;
+    size_t count;
+    uint16_t channel;
+    bool seek_started;
+    bool band_limit;
+    fm_scan_station_t current;
+    uint64_t dwell_end_time;
+} fm_scan_state_t;
+
 /**
  * \brief FM radio.
  */
 typedef struct si470x_t
 {
     i2c_inst_t *i2c_inst;
+    const fm_transport_t *transport; // NULL for hardware I2C
+    void *transport_context;
+    fm_bus_select_t bus_select;
+    void *bus_select_data;
     uint8_t reset_pin;
     uint8_t sdio_pin;
     uint8_t sclk_pin;
     bool enable_pull_ups;
     fm_config_t config;
     fm_seek_sensitivity_t seek_sensitivity;
-    float frequency;
+    uint16_t frequency; // 10 kHz units
     bool mute;
     bool softmute;
     fm_softmute_rate_t softmute_rate;
     fm_softmute_attenuation_t softmute_attenuation;
     bool mono;
+    bool rds_verbose;
     bool volext;
     uint8_t volume;
+    bool irq_enabled;
+    uint8_t irq_pin;
+    volatile bool irq_rds_pending;
+    volatile bool irq_stc_pending;
     uint16_t regs[16];
+    uint64_t status_read_time; // when STATUSRSSI..RDSD were last read, 0 if stale
+    uint32_t status_max_age_us;
+    bool status_rds_consumed; // RDS group in cached status already returned
+    uint16_t dirty_regs; // shadow registers not yet written, one bit per register
+    uint8_t update_depth;
     fm_async_state_t async;
+    fm_async_queue_t queue; // operations started when the current task completes
+    fm_dma_state_t dma;
+    fm_scan_state_t scan;
+#if FM_SI470X_STATS_ENABLE
+    fm_stats_t stats;
+#endif
 } si470x_t;
 
 /**
  * \brief Initialize the radio state.
  * 
  * @param radio Radio handle.
- * @param i2c_inst I2C instance.
+ * @param i2c_inst I2C instance, or NULL when using fm_set_transport().
  * @param reset_pin Reset pin.
  * @param sdio_pin SDIO pin.
  * @param sclk_pin SCLK pin.
@@ -210,6 +414,72 @@ typedef struct si470x_t
  */
 void fm_init(si470x_t *radio, i2c_inst_t *i2c_inst, uint8_t reset_pin, uint8_t sdio_pin, uint8_t sclk_pin, bool enable_pull_ups);
 
+/**
+ * \brief Enable interrupt-driven RDS and STC notifications.
+ * 
+ * Configures the chip's GPIO2 pin to pulse low when an RDS group is ready or a tune / seek
+ * operation completes, and routes it to a GPIO IRQ on the given pin. Afterwards,
+ * fm_read_rds_group() and the async tune / seek tasks only access the I2C bus once the chip
+ * has signaled new data.
+ * 
+ * The IRQ is enabled on the calling core. May be called before or after power up.
+ * 
+ * @param radio Radio handle.
+ * @param gpio2_pin Pin connected to Si470x GPIO2.
+ */
+void fm_enable_interrupts(si470x_t *radio, uint8_t gpio2_pin);
+
+/**
+ * \brief Use a custom transport for register transfers instead of hardware I2C.
+ * 
+ * Must be called before power up. The reset sequence still drives SDIO and the reset pin
+ * through GPIO to select 2-wire bus mode, then hands the pins to transport->init_pins().
+ * DMA can't be combined with a custom transport. See fm_pio_i2c.h for a PIO implementation.
+ * 
+ * @param radio Radio handle, initialized with a NULL I2C instance.
+ * @param transport Transport functions, or NULL for hardware I2C.
+ * @param context Transport state, passed to the transport functions.
+ */
+void fm_set_transport(si470x_t *radio, const fm_transport_t *transport, void *context);
+
+/**
+ * \brief Set a function to be called before each register transfer.
+ * 
+ * All Si470x chips share the same I2C address, so several chips on one I2C instance must be
+ * connected through a mux. This hook should route the bus to the given radio. It's called
+ * before every transfer, including the start of a DMA transfer.
+ * 
+ * @param radio Radio handle.
+ * @param bus_select Function to call, or NULL.
+ * @param user_data User data for bus_select.
+ */
+void fm_set_bus_select(si470x_t *radio, fm_bus_select_t bus_select, void *user_data);
+
+/**
+ * \brief Check if a DMA transfer is pending.
+ * 
+ * While true, no other device may use the radio's I2C instance.
+ * 
+ * @param radio Radio handle.
+ */
+bool fm_is_bus_busy(si470x_t *radio);
+
+/**
+ * \brief Use DMA for register transfers issued by asynchronous tasks.
+ * 
+ * Claims two unused DMA channels. Afterwards, async tasks start their I2C transfers in the
+ * background and pick up the results on a later fm_async_task_tick(), instead of stalling
+ * the CPU for the duration of the transfer. Synchronous calls wait for any pending transfer,
+ * then continue to use blocking I/O.
+ * 
+ * The I2C instance must not be shared with other devices while a transfer is pending.
+ * 
+ * @param radio Radio handle.
+ * @return true DMA enabled.
+ * @return false No DMA channels available.
+ */
+bool fm_enable_dma(si470x_t *radio);
+
 /**
  * \brief Power up the radio chip.
  * 
@@ -220,6 +490,24 @@ void fm_init(si470x_t *radio, i2c_inst_t *i2c_inst, uint8_t reset_pin, uint8_t s
  */
 void fm_power_up(si470x_t *radio, fm_config_t config);
 
+/**
+ * \brief Power up the radio chip without blocking.
+ * 
+ * A cold start takes over 600ms, most of it waiting for the crystal oscillator to stabilize.
+ * When waking after power down, the register state is reused and only the 110ms powerup time
+ * is spent. If config differs from the previous one, only the band settings are rewritten and
+ * the frequency is restored within the new band.
+ * 
+ * The task ends after tuning to the previous frequency, if any. If canceled after the chip has
+ * been enabled, the radio is left powered up but not tuned.
+ * 
+ * @param radio Radio handle.
+ * @param config FM regional settings.
+ * 
+ * @sa fm_async_task_tick(), fm_async_task_cancel()
+ */
+void fm_power_up_async(si470x_t *radio, fm_config_t config);
+
 /**
  * \brief Power down the radio chip.
  * 
@@ -257,6 +545,15 @@ fm_config_t fm_get_config(si470x_t *radio);
  */
 fm_frequency_range_t fm_get_frequency_range(si470x_t *radio);
 
+/**
+ * \brief Get the frequency range for the configured FM band, in 10 kHz units.
+ * 
+ * Same as fm_get_frequency_range(), but without floating point math.
+ * 
+ * @param radio Radio handle.
+ */
+fm_frequency_range_10khz_t fm_get_frequency_range_10khz(si470x_t *radio);
+
 /**
  * \brief Get the current FM frequency.
  * 
@@ -265,6 +562,14 @@ fm_frequency_range_t fm_get_frequency_range(si470x_t *radio);
  */
 float fm_get_frequency(si470x_t *radio);
 
+/**
+ * \brief Get the current FM frequency in 10 kHz units.
+ * 
+ * @param radio Radio handle.
+ * @return FM frequency in 10 kHz units, e.g. 8750 for 87.5 MHz.
+ */
+uint16_t fm_get_frequency_10khz(si470x_t *radio);
+
 /**
  * \brief Set the current FM frequency.
  * 
@@ -275,12 +580,22 @@ float fm_get_frequency(si470x_t *radio);
  */
 void fm_set_frequency_blocking(si470x_t *radio, float frequency);
 
+/**
+ * \brief Set the current FM frequency in 10 kHz units.
+ * 
+ * Same as fm_set_frequency_blocking(), but without floating point math.
+ * 
+ * @param radio Radio handle.
+ * @param frequency FM frequency in 10 kHz units.
+ */
+void fm_set_frequency_10khz_blocking(si470x_t *radio, uint16_t frequency);
+
 /**
  * \brief Set the current FM frequency without blocking.
  *
  * If canceled before completion, the tuner is stopped without restoring the original frequency.
  * 
- * May not be called while another async task is running.
+ * May not be called while another async task is running, use fm_async_enqueue() to run it afterwards.
  * 
  * @param radio Radio handle.
  * @param frequency FM frequency in MHz.
@@ -289,6 +604,42 @@ void fm_set_frequency_blocking(si470x_t *radio, float frequency);
  */
 void fm_set_frequency_async(si470x_t *radio, float frequency);
 
+/**
+ * \brief Set the current FM frequency in 10 kHz units without blocking.
+ * 
+ * Same as fm_set_frequency_async(), but without floating point math.
+ * 
+ * @param radio Radio handle.
+ * @param frequency FM frequency in 10 kHz units.
+ *
+ * @sa fm_async_task_tick(), fm_async_task_cancel()
+ */
+void fm_set_frequency_10khz_async(si470x_t *radio, uint16_t frequency);
+
+/**
+ * \brief Tune to a channel index.
+ * 
+ * The channel is the offset from the bottom of the band, in channel spacing steps. Unlike
+ * fm_set_frequency_10khz_blocking() this skips the band lookup, e.g. for callers that
+ * compute channels at compile time. Always tunes, even if already on the channel.
+ * 
+ * @param radio Radio handle.
+ * @param channel Channel index, must be within the band.
+ */
+void fm_set_channel_blocking(si470x_t *radio, uint16_t channel);
+
+/**
+ * \brief Tune to a channel index without blocking.
+ * 
+ * See fm_set_channel_blocking() and fm_set_frequency_async().
+ * 
+ * @param radio Radio handle.
+ * @param channel Channel index, must be within the band.
+ *
+ * @sa fm_async_task_tick(), fm_async_task_cancel()
+ */
+void fm_set_channel_async(si470x_t *radio, uint16_t channel);
+
 /**
  * \brief Get seek sensitivity.
  * 
@@ -328,11 +679,12 @@ bool fm_seek_blocking(si470x_t *radio, fm_seek_direction_t direction);
  * Seeks in the given direction until a station is detected. If the frequency range limit
  * is reached, it will wrap to the other end.
  * 
- * fm_get_frequency() may be used during the seek operation to monitor progress.
+ * fm_get_frequency() may be used during the seek operation to monitor progress. With interrupts
+ * enabled, progress is only updated once the seek completes.
  * 
  * If canceled before completion, the tuner is stopped without restoring the original frequency.
  * 
- * May not be called while another async task is running.
+ * May not be called while another async task is running, use fm_async_enqueue() to run it afterwards.
  * 
  * @param radio Radio handle.
  * @param direction Seek direction.
@@ -341,6 +693,62 @@ bool fm_seek_blocking(si470x_t *radio, fm_seek_direction_t direction);
  */
 void fm_seek_async(si470x_t *radio, fm_seek_direction_t direction);
 
+/**
+ * \brief Scan the whole band.
+ * 
+ * Scanning may take several seconds. To avoid blocking, use fm_scan_async().
+ * 
+ * @param radio Radio handle.
+ * @param config Scan settings.
+ * @param stations Output table, in ascending frequency order.
+ * @param capacity Maximum number of stations to store.
+ * @return Number of stations found.
+ */
+size_t fm_scan_blocking(si470x_t *radio, fm_scan_config_t config, fm_scan_station_t *stations, size_t capacity);
+
+/**
+ * \brief Scan the whole band without blocking.
+ * 
+ * Walks the band from bottom to top and records each station's frequency, RSSI, stereo
+ * indicator and, optionally, RDS PI code. Stops early if the table fills up. The task result
+ * is the number of stations found, or -1 if canceled.
+ * 
+ * Afterwards the radio remains tuned to the last scanned frequency. Audio is not muted during
+ * the scan.
+ * 
+ * May not be called while another async task is running.
+ * 
+ * @param radio Radio handle.
+ * @param config Scan settings.
+ * @param stations Output table, in ascending frequency order. Must remain valid until the task is done.
+ * @param capacity Maximum number of stations to store.
+ * 
+ * @sa fm_async_task_tick(), fm_async_task_cancel()
+ */
+void fm_scan_async(si470x_t *radio, fm_scan_config_t config, fm_scan_station_t *stations, size_t capacity);
+
+/**
+ * \brief Start a batch of setter calls.
+ * 
+ * Until the matching fm_commit_update(), setters only update the shadow registers. The
+ * changes are then sent in a single I2C transaction. Calls may be nested.
+ * 
+ * Setters called while an async task is running are batched the same way, and written
+ * on a later fm_async_task_tick().
+ * 
+ * @param radio Radio handle.
+ */
+void fm_begin_update(si470x_t *radio);
+
+/**
+ * \brief Finish a batch of setter calls.
+ * 
+ * Writes all registers changed since fm_begin_update(), unless nested within another batch.
+ * 
+ * @param radio Radio handle.
+ */
+void fm_commit_update(si470x_t *radio);
+
 /**
  * \brief Check whether audio is muted.
  * 
@@ -430,6 +838,31 @@ bool fm_get_mono(si470x_t *radio);
  */
 void fm_set_mono(si470x_t *radio, bool mono);
 
+/**
+ * \brief Check whether RDS verbose mode is enabled.
+ * 
+ * The default is standard mode.
+ * 
+ * @param radio Radio handle.
+ */
+bool fm_get_rds_verbose(si470x_t *radio);
+
+/**
+ * \brief Set whether RDS verbose mode is enabled.
+ * 
+ * In standard mode the chip only signals groups it has decoded without uncorrectable errors.
+ * In verbose mode every group is signaled, with per-block error levels and the decoder sync
+ * state in fm_status_t. Groups with some corrupted blocks still carry usable fields, e.g. the
+ * PS segment in block D, which raises the usable group rate under weak reception.
+ * 
+ * Groups read in verbose mode must be parsed with rds_parser_update_with_errors(), see
+ * fm_read_rds_group_with_errors().
+ * 
+ * @param radio Radio handle.
+ * @param rds_verbose Verbose mode value.
+ */
+void fm_set_rds_verbose(si470x_t *radio, bool rds_verbose);
+
 /**
  * \brief Get audio volume.
  * 
@@ -462,6 +895,29 @@ bool fm_get_volext(si470x_t *radio);
  */
 void fm_set_volume(si470x_t *radio, uint8_t volume, bool volext);
 
+/**
+ * \brief Set how long status reads may be served from cache.
+ * 
+ * By default (0) every status getter reads the chip. With a max age, the first getter reads
+ * STATUSRSSI..RDSD in one transfer, and fm_get_rssi(), fm_get_stereo_indicator(),
+ * fm_read_rds_group() and fm_get_status() reuse it until it's older than max_age_us.
+ * Register writes invalidate the cache. Each RDS group is returned only once.
+ * 
+ * @param radio Radio handle.
+ * @param max_age_us Maximum cache age in microseconds, 0 to disable caching.
+ */
+void fm_set_status_max_age(si470x_t *radio, uint32_t max_age_us);
+
+/**
+ * \brief Get signal and RDS status with a single read.
+ * 
+ * @param radio Radio handle.
+ * @param status Output status.
+ * 
+ * @sa fm_set_status_max_age()
+ */
+void fm_get_status(si470x_t *radio, fm_status_t *status);
+
 /**
  * \brief Get current FM signal strength.
  * 
@@ -493,7 +949,10 @@ bool fm_is_rds_supported(si470x_t *radio);
 /**
  * \brief Read an RDS data group.
  * 
- * Should be called every 40ms.
+ * In verbose mode the group may contain uncorrectable blocks, check fm_get_rds_block_errors().
+ * 
+ * Should be called every 40ms. With interrupts enabled, the I2C bus is only accessed after
+ * the chip has signaled a new group, so calling more often is cheap.
  * 
  * @param radio Radio handle.
  * @param blocks Output buffer.
@@ -502,6 +961,49 @@ bool fm_is_rds_supported(si470x_t *radio);
  */
 bool fm_read_rds_group(si470x_t *radio, uint16_t *blocks);
 
+/**
+ * \brief Read an RDS data group and its block error levels.
+ * 
+ * Like fm_read_rds_group() followed by fm_get_rds_block_errors(), but the blocks are decoded
+ * straight from the I2C buffer instead of going through the register mirror. Only
+ * STATUSRSSI..RDSD are transferred. If the status cache is fresh (see fm_set_status_max_age())
+ * the group is served from it without a transfer.
+ * 
+ * @param radio Radio handle.
+ * @param blocks Output buffer for blocks A-D.
+ * @param bler Output buffer for the error levels of blocks A-D.
+ * @return true RDS data ready, blocks and bler filled.
+ * @return false RDS data not yet ready.
+ */
+bool fm_read_rds_group_with_errors(si470x_t *radio, uint16_t *blocks, uint8_t *bler);
+
+/**
+ * \brief Read an RDS data group without blocking.
+ * 
+ * Mainly useful with DMA enabled, so the CPU isn't stalled while the RDS registers are
+ * transferred. The task result is 1 if a group was stored in blocks, 0 if not yet ready.
+ * 
+ * May not be called while another async task is running.
+ * 
+ * @param radio Radio handle.
+ * @param blocks Output buffer. Must remain valid until the task is done.
+ * 
+ * @sa fm_enable_dma(), fm_async_task_tick(), fm_async_task_set_callback()
+ */
+void fm_read_rds_group_async(si470x_t *radio, uint16_t *blocks);
+
+/**
+ * \brief Get the block error levels of the last RDS group.
+ * 
+ * Returns the BLERA-BLERD values captured by the last successful fm_read_rds_group(), without
+ * accessing the I2C bus.
+ * 
+ * @param radio Radio handle.
+ * @param bler Output buffer for blocks A-D. Each level is 0 (no errors), 1 (1-2 corrected errors),
+ *   2 (3-5 corrected errors), or 3 (uncorrectable).
+ */
+void fm_get_rds_block_errors(si470x_t *radio, uint8_t *bler);
+
 /**
  * \brief Update the current asynchronous task.
  * 
@@ -510,18 +1012,81 @@ bool fm_read_rds_group(si470x_t *radio, uint16_t *blocks);
  * called periodically until the task is done. The tick interval is up to the user
  * (every 40ms should be fine).
  * 
+ * Tasks schedule their own status polls, first after the expected completion time and then
+ * with growing intervals. Ticks in between return without accessing the I2C bus, so ticking
+ * more often only reduces latency.
+ * 
  * @param radio Radio handle.
  * @return Task status.
  */
 fm_async_progress_t fm_async_task_tick(si470x_t *radio);
 
+/**
+ * \brief Set a function to be called when the current asynchronous task completes.
+ * 
+ * The callback is invoked from fm_async_task_tick(), after the task has been cleared, so it
+ * may start another task. It isn't invoked if the task is canceled.
+ * 
+ * With queued operations, the callback is kept until the last one completes or one fails,
+ * and receives the result of that operation.
+ * 
+ * @param radio Radio handle.
+ * @param callback Completion callback.
+ * @param user_data User data for callback.
+ */
+void fm_async_task_set_callback(si470x_t *radio, fm_async_callback_t callback, void *user_data);
+
 /**
  * \brief Abort the current asynchronous task.
  * 
+ * Queued operations are discarded.
+ * 
  * @param radio Radio handle.
  */
 void fm_async_task_cancel(si470x_t *radio);
 
+/**
+ * \brief Queue an operation to run after the current async task.
+ * 
+ * Operations run in order, each started from fm_async_task_tick() once the previous one
+ * completes. If none is running, the operation starts right away. A failed operation
+ * (negative result) discards the rest of the queue, e.g.
+ * 
+ *     fm_async_enqueue(&radio, (fm_async_op_t){.type = FM_ASYNC_OP_SEEK, .direction = FM_SEEK_UP});
+ *     fm_async_enqueue(&radio, (fm_async_op_t){.type = FM_ASYNC_OP_WAIT_RDS_PI, .timeout_ms = 1000});
+ *     fm_async_enqueue(&radio, (fm_async_op_t){.type = FM_ASYNC_OP_SET_MUTE, .mute = false});
+ * 
+ * only unmutes once a station with RDS has been found. fm_async_task_tick() reports done
+ * when the queue has drained.
+ * 
+ * Setters don't need to be queued, they may be called at any time and take effect between
+ * status polls of the current task, also in the middle of a seek.
+ * 
+ * @param radio Radio handle.
+ * @param op Operation.
+ * @return false The queue is full.
+ */
+bool fm_async_enqueue(si470x_t *radio, fm_async_op_t op);
+
+#if FM_SI470X_STATS_ENABLE
+/**
+ * \brief Get a snapshot of the diagnostic counters.
+ * 
+ * Only available with FM_SI470X_STATS_ENABLE. Counters wrap around on overflow.
+ * 
+ * @param radio Radio handle.
+ * @param stats Output counters.
+ */
+void fm_get_stats(si470x_t *radio, fm_stats_t *stats);
+
+/**
+ * \brief Zero the diagnostic counters.
+ * 
+ * @param radio Radio handle.
+ */
+void fm_reset_stats(si470x_t *radio);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
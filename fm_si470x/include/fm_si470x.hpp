@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_SI470X_HPP_
+#define _FM_SI470X_HPP_
+
+#include <fm_si470x.h>
+#include <cstdint>
+
+/** \file fm_si470x.hpp
+ *
+ * \brief Header-only C++17 wrapper with compile-time regional settings.
+ *
+ * Band, channel spacing, de-emphasis and chip variant are template parameters, so frequency
+ * range and channel math folds to constants, and tuning goes straight to fm_set_channel_async()
+ * without a runtime band lookup. Frequencies given as template arguments are checked at
+ * compile time.
+ *
+ * RDS methods only compile for the Si4703. A Si4702 build never references the RDS functions
+ * of the C driver, so they are dropped by the linker's section garbage collection.
+ *
+ * Usage:
+ *
+ *     fm::radio_europe<> radio;
+ *     radio.init(i2c_default, RESET_PIN, SDIO_PIN, SCLK_PIN, true);
+ *     radio.power_up();
+ *     radio.tune<10100>(); // 101.0 MHz, range checked at compile time
+ *     radio.set_volume(15, true);
+ *     radio.set_mute(false);
+ */
+
+namespace fm {
+
+/**
+ * \brief Chip variant.
+ */
+enum class chip_variant
+{
+    si4702, /**< No RDS. */
+    si4703,
+};
+
+/**
+ * \brief Compile-time frequency range of a band, in 10 kHz units.
+ */
+template <fm_band_t Band, fm_channel_spacing_t Spacing>
+struct band_traits
+{
+    static constexpr uint16_t bottom = (Band == FM_BAND_COMMON ? 8750 : 7600);
+    static constexpr uint16_t top = (Band == FM_BAND_JAPAN ? 9000 : 10800);
+    static constexpr uint16_t spacing = (Spacing == FM_CHANNEL_SPACING_200 ? 20 : Spacing == FM_CHANNEL_SPACING_100 ? 10 : 5);
+    static constexpr uint16_t channel_count = (top - bottom) / spacing + 1;
+
+    /** Check if a frequency is inside the band and on a channel. */
+    static constexpr bool is_channel(uint16_t frequency) {
+        return bottom <= frequency && frequency <= top && (frequency - bottom) % spacing == 0;
+    }
+
+    /** Limit a frequency to the band. */
+    static constexpr uint16_t clamp(uint16_t frequency) {
+        return frequency < bottom ? bottom : (top < frequency ? top : frequency);
+    }
+
+    /** Nearest channel index of a frequency inside the band. */
+    static constexpr uint16_t to_channel(uint16_t frequency) {
+        return (frequency - bottom + spacing / 2) / spacing;
+    }
+
+    /** Frequency of a channel index. */
+    static constexpr uint16_t to_frequency(uint16_t channel) {
+        return bottom + channel * spacing;
+    }
+
+    /** Range in the C driver representation. */
+    static constexpr fm_frequency_range_10khz_t range() {
+        return fm_frequency_range_10khz_t{bottom, top, spacing};
+    }
+};
+
+/**
+ * \brief Si470x radio with fixed regional settings.
+ *
+ * Thin inline layer over the C driver. The C handle stays accessible through handle(), for
+ * the parts of the API not wrapped here (DMA, transports, scan, async callbacks).
+ */
+template <fm_band_t Band, fm_channel_spacing_t Spacing, fm_deemphasis_t Deemphasis, chip_variant Chip = chip_variant::si4703>
+class radio
+{
+public:
+    using band = band_traits<Band, Spacing>;
+
+    static constexpr fm_config_t config = {Band, Spacing, Deemphasis};
+    static constexpr bool has_rds = (Chip == chip_variant::si4703);
+
+    /** See fm_init(). */
+    void init(i2c_inst_t *i2c_inst, uint8_t reset_pin, uint8_t sdio_pin, uint8_t sclk_pin, bool enable_pull_ups) {
+        fm_init(&radio_, i2c_inst, reset_pin, sdio_pin, sclk_pin, enable_pull_ups);
+    }
+
+    /** See fm_enable_interrupts(). */
+    void enable_interrupts(uint8_t gpio2_pin) {
+        fm_enable_interrupts(&radio_, gpio2_pin);
+    }
+
+    /** See fm_power_up(). */
+    void power_up() {
+        fm_power_up(&radio_, config);
+    }
+
+    /** See fm_power_up_async(). */
+    void power_up_async() {
+        fm_power_up_async(&radio_, config);
+    }
+
+    /** See fm_power_down(). */
+    void power_down() {
+        fm_power_down(&radio_);
+    }
+
+    /** See fm_is_powered_up(). */
+    bool is_powered_up() {
+        return fm_is_powered_up(&radio_);
+    }
+
+    /** Current frequency in 10 kHz units, see fm_get_frequency_10khz(). */
+    uint16_t frequency() const {
+        return radio_.frequency;
+    }
+
+    /** Tune to a frequency known at compile time. */
+    template <uint16_t Frequency>
+    void tune() {
+        static_assert(band::is_channel(Frequency), "frequency outside of band or between channels");
+        fm_set_channel_blocking(&radio_, band::to_channel(Frequency));
+    }
+
+    /** Tune to a frequency in 10 kHz units, clamped to the band. */
+    void tune(uint16_t frequency) {
+        fm_set_channel_blocking(&radio_, band::to_channel(band::clamp(frequency)));
+    }
+
+    /** Tune without blocking, see fm_set_channel_async(). */
+    void tune_async(uint16_t frequency) {
+        fm_set_channel_async(&radio_, band::to_channel(band::clamp(frequency)));
+    }
+
+    /** See fm_seek_blocking(). */
+    bool seek(fm_seek_direction_t direction) {
+        return fm_seek_blocking(&radio_, direction);
+    }
+
+    /** See fm_seek_async(). */
+    void seek_async(fm_seek_direction_t direction) {
+        fm_seek_async(&radio_, direction);
+    }
+
+    /** See fm_async_task_tick(). */
+    fm_async_progress_t tick() {
+        return fm_async_task_tick(&radio_);
+    }
+
+    /** Check if an async task is running. */
+    bool is_busy() const {
+        return radio_.async.task != nullptr;
+    }
+
+    /** See fm_async_task_cancel(). */
+    void cancel() {
+        fm_async_task_cancel(&radio_);
+    }
+
+    /** See fm_async_enqueue(). */
+    bool enqueue(const fm_async_op_t &op) {
+        return fm_async_enqueue(&radio_, op);
+    }
+
+    /** See fm_set_seek_sensitivity(). */
+    void set_seek_sensitivity(fm_seek_sensitivity_t seek_sensitivity) {
+        fm_set_seek_sensitivity(&radio_, seek_sensitivity);
+    }
+
+    /** See fm_set_mute(). */
+    void set_mute(bool mute) {
+        fm_set_mute(&radio_, mute);
+    }
+
+    /** See fm_get_mute(). */
+    bool mute() const {
+        return radio_.mute;
+    }
+
+    /** See fm_set_softmute(). */
+    void set_softmute(bool softmute) {
+        fm_set_softmute(&radio_, softmute);
+    }
+
+    /** See fm_set_mono(). */
+    void set_mono(bool mono) {
+        fm_set_mono(&radio_, mono);
+    }
+
+    /** See fm_set_volume(). */
+    void set_volume(uint8_t volume, bool volext) {
+        fm_set_volume(&radio_, volume, volext);
+    }
+
+    /** See fm_get_volume(). */
+    uint8_t volume() const {
+        return radio_.volume;
+    }
+
+    /** See fm_get_rssi(). */
+    uint8_t rssi() {
+        return fm_get_rssi(&radio_);
+    }
+
+    /** See fm_get_status(). */
+    void status(fm_status_t &status) {
+        fm_get_status(&radio_, &status);
+    }
+
+    /** See fm_set_status_max_age(). */
+    void set_status_max_age(uint32_t max_age_us) {
+        fm_set_status_max_age(&radio_, max_age_us);
+    }
+
+    /** See fm_read_rds_group_with_errors(). Si4703 only. */
+    bool read_rds_group(uint16_t *blocks, uint8_t *bler) {
+        static_assert(has_rds, "Si4702 has no RDS");
+        return fm_read_rds_group_with_errors(&radio_, blocks, bler);
+    }
+
+    /** See fm_read_rds_group_async(). Si4703 only. */
+    void read_rds_group_async(uint16_t *blocks) {
+        static_assert(has_rds, "Si4702 has no RDS");
+        fm_read_rds_group_async(&radio_, blocks);
+    }
+
+    /** See fm_set_rds_verbose(). Si4703 only. */
+    void set_rds_verbose(bool rds_verbose) {
+        static_assert(has_rds, "Si4702 has no RDS");
+        fm_set_rds_verbose(&radio_, rds_verbose);
+    }
+
+    /** C driver handle. */
+    si470x_t *handle() {
+        return &radio_;
+    }
+
+private:
+    si470x_t radio_;
+};
+
+/** Settings of fm_config_usa(). */
+template <chip_variant Chip = chip_variant::si4703>
+using radio_usa = radio<FM_BAND_COMMON, FM_CHANNEL_SPACING_200, FM_DEEMPHASIS_75, Chip>;
+
+/** Settings of fm_config_europe(). */
+template <chip_variant Chip = chip_variant::si4703>
+using radio_europe = radio<FM_BAND_COMMON, FM_CHANNEL_SPACING_100, FM_DEEMPHASIS_50, Chip>;
+
+/** Settings of fm_config_japan_wide(). */
+template <chip_variant Chip = chip_variant::si4703>
+using radio_japan_wide = radio<FM_BAND_JAPAN_WIDE, FM_CHANNEL_SPACING_100, FM_DEEMPHASIS_50, Chip>;
+
+/** Settings of fm_config_japan(). */
+template <chip_variant Chip = chip_variant::si4703>
+using radio_japan = radio<FM_BAND_JAPAN, FM_CHANNEL_SPACING_100, FM_DEEMPHASIS_50, Chip>;
+
+} // namespace fm
+
+#endif // _FM_SI470X_HPP_
@@ -0,0 +1,150 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_signal_monitor.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+#define SAMPLE_STEREO (1 << 0)
+#define SAMPLE_SYNCED (1 << 1)
+#define SAMPLE_GROUP (1 << 2) // bad_blocks is valid
+
+//
+// window
+//
+
+static void fm_signal_monitor_apply(fm_signal_monitor_t *monitor, const fm_signal_sample_t *sample, int sign) {
+    // add (sign = 1) or remove (sign = -1) a sample from the running totals
+    monitor->rssi_histogram[sample->rssi] += sign;
+    monitor->rssi_sum += sign * sample->rssi;
+    monitor->stereo_count += sign * ((sample->flags & SAMPLE_STEREO) != 0);
+    monitor->synced_count += sign * ((sample->flags & SAMPLE_SYNCED) != 0);
+    monitor->group_count += sign * ((sample->flags & SAMPLE_GROUP) != 0);
+    monitor->bad_block_count += sign * sample->bad_blocks;
+}
+
+static void fm_signal_monitor_push(fm_signal_monitor_t *monitor, const fm_signal_sample_t *sample) {
+    fm_signal_sample_t *slot = &monitor->samples[monitor->head];
+    if (monitor->count == FM_SIGNAL_MONITOR_WINDOW) {
+        fm_signal_monitor_apply(monitor, slot, -1); // evict oldest
+    } else {
+        monitor->count++;
+    }
+    *slot = *sample;
+    fm_signal_monitor_apply(monitor, slot, 1);
+    monitor->head = (monitor->head + 1) % FM_SIGNAL_MONITOR_WINDOW;
+}
+
+static void fm_signal_monitor_sample(fm_signal_monitor_t *monitor) {
+    si470x_t *radio = monitor->radio;
+    uint16_t frequency = fm_get_frequency_10khz(radio);
+    if (frequency != monitor->frequency) {
+        fm_signal_monitor_reset(monitor);
+        monitor->frequency = frequency;
+    }
+
+    fm_status_t status;
+    fm_get_status(radio, &status);
+    fm_signal_sample_t sample = {
+        .rssi = MIN(status.rssi, FM_SIGNAL_MONITOR_MAX_RSSI),
+        .flags = (status.stereo ? SAMPLE_STEREO : 0) | (status.rds_synced ? SAMPLE_SYNCED : 0),
+    };
+    if (status.rds_ready) {
+        // BLER describes the pending group
+        sample.flags |= SAMPLE_GROUP;
+        for (size_t i = 0; i < 4; i++) {
+            sample.bad_blocks += (status.bler[i] == 3);
+        }
+    }
+    fm_signal_monitor_push(monitor, &sample);
+    monitor->sample_total++;
+}
+
+static uint8_t fm_signal_monitor_percent(uint32_t part, uint32_t total) {
+    return total == 0 ? 0 : (uint8_t)((100 * part + total / 2) / total);
+}
+
+//
+// public interface
+//
+
+void fm_signal_monitor_init(fm_signal_monitor_t *monitor, si470x_t *radio, uint32_t interval_ms) {
+    assert(0 < interval_ms);
+
+    memset(monitor, 0, sizeof(fm_signal_monitor_t));
+
+    monitor->radio = radio;
+    monitor->interval_us = interval_ms * 1000;
+}
+
+bool fm_signal_monitor_tick(fm_signal_monitor_t *monitor) {
+    si470x_t *radio = monitor->radio;
+    uint64_t now = time_us_64();
+    if (now < monitor->next_time) {
+        return false;
+    }
+    if (monitor->next_time == 0) {
+        monitor->next_time = now; // first tick starts the grid
+    }
+    // stay on the grid, skipping sample times that have already passed
+    uint64_t late = (now - monitor->next_time) / monitor->interval_us;
+    monitor->missed += (uint32_t)late;
+    monitor->next_time += (late + 1) * monitor->interval_us;
+
+    if (!fm_is_powered_up(radio) || radio->async.task != NULL) {
+        monitor->missed++;
+        return false;
+    }
+    fm_signal_monitor_sample(monitor);
+    return true;
+}
+
+void fm_signal_monitor_reset(fm_signal_monitor_t *monitor) {
+    memset(monitor->rssi_histogram, 0, sizeof(monitor->rssi_histogram));
+    monitor->head = 0;
+    monitor->count = 0;
+    monitor->rssi_sum = 0;
+    monitor->stereo_count = 0;
+    monitor->synced_count = 0;
+    monitor->group_count = 0;
+    monitor->bad_block_count = 0;
+}
+
+void fm_signal_monitor_get_stats(const fm_signal_monitor_t *monitor, fm_signal_stats_t *stats) {
+    memset(stats, 0, sizeof(fm_signal_stats_t));
+    uint8_t count = monitor->count;
+    if (count == 0) {
+        return;
+    }
+    stats->sample_count = count;
+    stats->rssi_min = fm_signal_monitor_get_rssi_percentile(monitor, 0);
+    stats->rssi_max = fm_signal_monitor_get_rssi_percentile(monitor, 100);
+    stats->rssi_mean = (uint8_t)((monitor->rssi_sum + count / 2) / count);
+    stats->rssi_median = fm_signal_monitor_get_rssi_percentile(monitor, 50);
+    stats->stereo_percent = fm_signal_monitor_percent(monitor->stereo_count, count);
+    stats->rds_synced_percent = fm_signal_monitor_percent(monitor->synced_count, count);
+    stats->rds_group_count = monitor->group_count;
+    stats->block_error_percent = fm_signal_monitor_percent(monitor->bad_block_count, 4u * monitor->group_count);
+}
+
+uint8_t fm_signal_monitor_get_rssi_percentile(const fm_signal_monitor_t *monitor, uint8_t percent) {
+    assert(percent <= 100);
+
+    uint8_t count = monitor->count;
+    if (count == 0) {
+        return 0;
+    }
+    // nearest rank: smallest value with at least percent% of the samples at or below it
+    uint32_t rank = MAX((percent * count + 99u) / 100u, 1u);
+    uint32_t seen = 0;
+    for (uint rssi = 0; rssi <= FM_SIGNAL_MONITOR_MAX_RSSI; rssi++) {
+        seen += monitor->rssi_histogram[rssi];
+        if (rank <= seen) {
+            return (uint8_t)rssi;
+        }
+    }
+    return FM_SIGNAL_MONITOR_MAX_RSSI;
+}
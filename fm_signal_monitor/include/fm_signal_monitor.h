@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_SIGNAL_MONITOR_H_
+#define _FM_SIGNAL_MONITOR_H_
+
+#include <fm_si470x.h>
+#include <assert.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_signal_monitor.h
+ *
+ * \brief Signal quality statistics over a sliding window.
+ *
+ * Samples RSSI, the stereo indicator, RDS sync and RDS block errors at a fixed rate, using a
+ * single status read per sample. Sample times are scheduled on a fixed grid, so the cadence
+ * doesn't drift with the tick rate of the main loop; ticks that come late take one sample
+ * and count the ones that were missed.
+ *
+ * Sums and an RSSI histogram are updated as samples enter and leave the window, so
+ * statistics and percentiles are computed without touching the bus or sorting.
+ *
+ * Samples are taken from fm_signal_monitor_tick() rather than from a timer interrupt, so
+ * reads never overlap a transfer of the main loop. The window is cleared when the frequency
+ * changes.
+ *
+ * Usage:
+ *
+ *     fm_signal_monitor_init(&monitor, &radio, 100);
+ *     while (true) {
+ *         fm_signal_monitor_tick(&monitor);
+ *         ...
+ *         fm_signal_stats_t stats;
+ *         fm_signal_monitor_get_stats(&monitor, &stats);
+ *     }
+ */
+
+#ifndef FM_SIGNAL_MONITOR_WINDOW
+#define FM_SIGNAL_MONITOR_WINDOW 64
+#endif
+
+static_assert(FM_SIGNAL_MONITOR_WINDOW <= 255, "sample counts are 8-bit");
+
+/** RSSI values above this are counted in the top histogram bin. */
+#define FM_SIGNAL_MONITOR_MAX_RSSI 127
+
+/**
+ * \brief Statistics of the samples in the window.
+ */
+typedef struct fm_signal_stats_t
+{
+    uint8_t sample_count; /**< Samples in the window. */
+    uint8_t rssi_min;
+    uint8_t rssi_max;
+    uint8_t rssi_mean;
+    uint8_t rssi_median;
+    uint8_t stereo_percent; /**< Share of samples with the stereo indicator set. */
+    uint8_t rds_synced_percent; /**< Share of samples with RDS synchronized. */
+    uint8_t rds_group_count; /**< Samples with an RDS group pending. */
+    uint8_t block_error_percent; /**< Share of uncorrectable blocks in sampled RDS groups. Only meaningful in RDS verbose mode. */
+} fm_signal_stats_t;
+
+// private
+typedef struct fm_signal_sample_t
+{
+    uint8_t rssi;
+    uint8_t flags;
+    uint8_t bad_blocks;
+} fm_signal_sample_t;
+
+/**
+ * \brief Signal monitor state.
+ */
+typedef struct fm_signal_monitor_t
+{
+    si470x_t *radio;
+    uint32_t interval_us;
+    uint64_t next_time;
+    uint16_t frequency; // samples belong to this frequency
+    fm_signal_sample_t samples[FM_SIGNAL_MONITOR_WINDOW];
+    uint8_t head; // next slot to write
+    uint8_t count;
+    uint8_t rssi_histogram[FM_SIGNAL_MONITOR_MAX_RSSI + 1];
+    uint16_t rssi_sum;
+    uint8_t stereo_count;
+    uint8_t synced_count;
+    uint8_t group_count;
+    uint16_t bad_block_count;
+    uint32_t sample_total; /**< Samples taken since init. */
+    uint32_t missed; /**< Sample times skipped, because of late ticks or a busy radio. */
+} fm_signal_monitor_t;
+
+/**
+ * \brief Initialize the signal monitor.
+ *
+ * @param monitor Signal monitor.
+ * @param radio Radio handle. Need not be powered up yet.
+ * @param interval_ms Time between samples.
+ */
+void fm_signal_monitor_init(fm_signal_monitor_t *monitor, si470x_t *radio, uint32_t interval_ms);
+
+/**
+ * \brief Take a sample if one is due.
+ *
+ * Call at least as often as the sample interval. Does nothing while the radio is powered
+ * down or runs an async task.
+ *
+ * @param monitor Signal monitor.
+ * @return true A sample was taken.
+ */
+bool fm_signal_monitor_tick(fm_signal_monitor_t *monitor);
+
+/**
+ * \brief Clear the window.
+ *
+ * Done automatically when the frequency changes.
+ *
+ * @param monitor Signal monitor.
+ */
+void fm_signal_monitor_reset(fm_signal_monitor_t *monitor);
+
+/**
+ * \brief Get statistics of the samples in the window.
+ *
+ * @param monitor Signal monitor.
+ * @param stats Output statistics, all zero if there are no samples.
+ */
+void fm_signal_monitor_get_stats(const fm_signal_monitor_t *monitor, fm_signal_stats_t *stats);
+
+/**
+ * \brief Get an RSSI percentile of the samples in the window.
+ *
+ * E.g. the 10th percentile is a robust "worst case" for AF decisions, unaffected by
+ * single dropouts.
+ *
+ * @param monitor Signal monitor.
+ * @param percent Percentile, from 0 (minimum) to 100 (maximum).
+ * @return RSSI, or 0 if there are no samples.
+ */
+uint8_t fm_signal_monitor_get_rssi_percentile(const fm_signal_monitor_t *monitor, uint8_t percent);
+
+/**
+ * \brief Get the number of samples in the window.
+ *
+ * @param monitor Signal monitor.
+ */
+static inline uint8_t fm_signal_monitor_get_count(const fm_signal_monitor_t *monitor) {
+    return monitor->count;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_SIGNAL_MONITOR_H_
@@ -0,0 +1,330 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_station_db.h>
+#include <hardware/sync.h>
+#include <string.h>
+
+static_assert(FM_STATION_DB_FLASH_OFFSET % FLASH_SECTOR_SIZE == 0, "");
+static_assert(2 <= FM_STATION_DB_SECTORS, "the current slot must survive erasing the next sector");
+
+static const uint32_t SLOT_MAGIC = 0x42445346; // "FSDB"
+
+// slot layout: header, then count records, padded to whole pages
+typedef struct fm_station_db_header_t
+{
+    uint32_t magic;
+    uint32_t sequence;
+    uint16_t count;
+    uint16_t record_size; // layout check, in case FM_STATION_DB_MAX_ALT_FREQS changes
+    uint32_t crc; // of the records
+} fm_station_db_header_t;
+
+#define SLOT_SIZE_RAW (sizeof(fm_station_db_header_t) + FM_STATION_DB_CAPACITY * sizeof(fm_station_record_t))
+#define SLOT_SIZE ((SLOT_SIZE_RAW + FLASH_PAGE_SIZE - 1) / FLASH_PAGE_SIZE * FLASH_PAGE_SIZE)
+#define SLOTS_PER_SECTOR (FLASH_SECTOR_SIZE / SLOT_SIZE)
+#define SLOT_COUNT (SLOTS_PER_SECTOR * FM_STATION_DB_SECTORS)
+
+static_assert(SLOT_SIZE <= FLASH_SECTOR_SIZE, "reduce FM_STATION_DB_CAPACITY");
+
+//
+// flash slots
+//
+
+static uint32_t fm_station_db_crc32(const uint8_t *data, size_t len) {
+    // bitwise CRC-32, only run on load / save
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (size_t bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (0xEDB88320 & -(crc & 1));
+        }
+    }
+    return ~crc;
+}
+
+static uint32_t fm_station_db_slot_offset(size_t slot) {
+    size_t sector = slot / SLOTS_PER_SECTOR;
+    return FM_STATION_DB_FLASH_OFFSET + sector * FLASH_SECTOR_SIZE + (slot % SLOTS_PER_SECTOR) * SLOT_SIZE;
+}
+
+static const uint8_t *fm_station_db_slot_data(size_t slot) {
+    return (const uint8_t *)(uintptr_t)(XIP_BASE + fm_station_db_slot_offset(slot));
+}
+
+static bool fm_station_db_is_slot_valid(size_t slot, fm_station_db_header_t *header) {
+    const uint8_t *data = fm_station_db_slot_data(slot);
+    memcpy(header, data, sizeof(fm_station_db_header_t));
+    if (header->magic != SLOT_MAGIC || header->record_size != sizeof(fm_station_record_t)
+        || FM_STATION_DB_CAPACITY < header->count) {
+        return false; // erased, or written by an incompatible build
+    }
+    size_t records_size = header->count * sizeof(fm_station_record_t);
+    return fm_station_db_crc32(data + sizeof(fm_station_db_header_t), records_size) == header->crc;
+}
+
+static bool fm_station_db_is_slot_blank(size_t slot) {
+    const uint8_t *data = fm_station_db_slot_data(slot);
+    for (size_t i = 0; i < SLOT_SIZE; i++) {
+        if (data[i] != 0xFF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static size_t fm_station_db_next_slot(size_t slot) {
+    slot = (slot + 1) % SLOT_COUNT;
+    if (slot % SLOTS_PER_SECTOR != 0 && !fm_station_db_is_slot_blank(slot)) {
+        // left over from an interrupted save, can't be programmed without an erase
+        slot = (slot / SLOTS_PER_SECTOR + 1) % FM_STATION_DB_SECTORS * SLOTS_PER_SECTOR;
+    }
+    return slot;
+}
+
+static void fm_station_db_program_slot(size_t slot, const fm_station_db_header_t *header, const fm_station_record_t *records) {
+    uint32_t offset = fm_station_db_slot_offset(slot);
+    size_t records_size = header->count * sizeof(fm_station_record_t);
+    size_t size = sizeof(fm_station_db_header_t) + records_size;
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (slot % SLOTS_PER_SECTOR == 0) {
+        // entering a sector, its old slots are at least a full ring behind
+        flash_range_erase(offset, FLASH_SECTOR_SIZE);
+    }
+    restore_interrupts(irq_state);
+
+    // program page by page, from a RAM copy; XIP is unavailable while programming
+    uint8_t page[FLASH_PAGE_SIZE];
+    for (size_t page_offset = 0; page_offset < size; page_offset += FLASH_PAGE_SIZE) {
+        memset(page, 0xFF, sizeof(page));
+        for (size_t i = 0; i < FLASH_PAGE_SIZE && page_offset + i < size; i++) {
+            size_t pos = page_offset + i;
+            page[i] = (pos < sizeof(fm_station_db_header_t))
+                ? ((const uint8_t *)header)[pos]
+                : ((const uint8_t *)records)[pos - sizeof(fm_station_db_header_t)];
+        }
+        irq_state = save_and_disable_interrupts();
+        flash_range_program(offset + page_offset, page, FLASH_PAGE_SIZE);
+        restore_interrupts(irq_state);
+    }
+}
+
+//
+// records
+//
+
+static size_t fm_station_db_lower_bound(const fm_station_db_t *db, uint16_t frequency) {
+    size_t lo = 0;
+    size_t hi = db->count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (db->stations[mid].frequency < frequency) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static void fm_station_db_erase_at(fm_station_db_t *db, size_t index) {
+    memmove(&db->stations[index], &db->stations[index + 1], (db->count - index - 1) * sizeof(fm_station_record_t));
+    db->count--;
+    db->dirty = true;
+}
+
+static fm_station_record_t *fm_station_db_insert(fm_station_db_t *db, uint16_t frequency, uint8_t rssi) {
+    if (db->count == FM_STATION_DB_CAPACITY) {
+        size_t weakest = 0;
+        for (size_t i = 1; i < db->count; i++) {
+            if (db->stations[i].rssi < db->stations[weakest].rssi) {
+                weakest = i;
+            }
+        }
+        if (rssi <= db->stations[weakest].rssi) {
+            return NULL;
+        }
+        fm_station_db_erase_at(db, weakest);
+    }
+    size_t index = fm_station_db_lower_bound(db, frequency);
+    memmove(&db->stations[index + 1], &db->stations[index], (db->count - index) * sizeof(fm_station_record_t));
+    db->count++;
+    db->dirty = true;
+
+    fm_station_record_t *record = &db->stations[index];
+    memset(record, 0, sizeof(fm_station_record_t));
+    record->frequency = frequency;
+    record->rssi = rssi;
+    return record;
+}
+
+static fm_station_record_t *fm_station_db_get_or_insert(fm_station_db_t *db, uint16_t frequency, uint8_t rssi) {
+    size_t index = fm_station_db_lower_bound(db, frequency);
+    if (index < db->count && db->stations[index].frequency == frequency) {
+        db->stations[index].rssi = rssi; // not worth a flash write on its own
+        return &db->stations[index];
+    }
+    return fm_station_db_insert(db, frequency, rssi);
+}
+
+static void fm_station_db_update_rds(fm_station_db_t *db, fm_station_record_t *record, const rds_parser_t *parser) {
+    // copy what the parser knows, keep stored fields it hasn't received yet
+    uint16_t pi = rds_get_program_id(parser);
+    if (pi != 0 && record->pi != pi) {
+        record->pi = pi;
+        db->dirty = true;
+    }
+    const char *ps_str = rds_get_program_service_name_str(parser);
+    if (ps_str[0] != '\0' && memcmp(record->ps, ps_str, sizeof(record->ps)) != 0) {
+        memcpy(record->ps, ps_str, sizeof(record->ps));
+        db->dirty = true;
+    }
+#if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+    size_t alt_freq_count = rds_get_alternative_frequency_count(parser);
+    if (alt_freq_count != 0) {
+        if (FM_STATION_DB_MAX_ALT_FREQS < alt_freq_count) {
+            alt_freq_count = FM_STATION_DB_MAX_ALT_FREQS;
+        }
+        uint8_t alt_freqs[FM_STATION_DB_MAX_ALT_FREQS];
+        for (size_t i = 0; i < alt_freq_count; i++) {
+            alt_freqs[i] = rds_get_alternative_frequency(parser, i);
+        }
+        if (record->alt_freq_count != alt_freq_count || memcmp(record->alt_freqs, alt_freqs, alt_freq_count) != 0) {
+            record->alt_freq_count = (uint8_t)alt_freq_count;
+            memcpy(record->alt_freqs, alt_freqs, alt_freq_count);
+            db->dirty = true;
+        }
+    }
+#endif
+}
+
+//
+// public interface
+//
+
+bool fm_station_db_init(fm_station_db_t *db) {
+    memset(db, 0, sizeof(fm_station_db_t));
+
+    bool found = false;
+    fm_station_db_header_t header;
+    for (size_t slot = 0; slot < SLOT_COUNT; slot++) {
+        if (!fm_station_db_is_slot_valid(slot, &header)) {
+            continue;
+        }
+        if (!found || (int32_t)(header.sequence - db->sequence) > 0) {
+            found = true;
+            db->sequence = header.sequence;
+            db->slot = (uint16_t)slot;
+            db->count = header.count;
+        }
+    }
+    if (found) {
+        const uint8_t *data = fm_station_db_slot_data(db->slot);
+        memcpy(db->stations, data + sizeof(fm_station_db_header_t), db->count * sizeof(fm_station_record_t));
+    } else {
+        db->slot = SLOT_COUNT - 1; // first save goes to slot 0
+    }
+    return found;
+}
+
+void fm_station_db_save(fm_station_db_t *db) {
+    if (!db->dirty) {
+        return;
+    }
+    size_t slot = fm_station_db_next_slot(db->slot);
+    fm_station_db_header_t header = {
+        .magic = SLOT_MAGIC,
+        .sequence = db->sequence + 1,
+        .count = db->count,
+        .record_size = sizeof(fm_station_record_t),
+        .crc = fm_station_db_crc32((const uint8_t *)db->stations, db->count * sizeof(fm_station_record_t)),
+    };
+    fm_station_db_program_slot(slot, &header, db->stations);
+
+    db->sequence = header.sequence;
+    db->slot = (uint16_t)slot;
+    db->dirty = false;
+}
+
+void fm_station_db_clear(fm_station_db_t *db) {
+    if (db->count != 0) {
+        db->count = 0;
+        db->dirty = true;
+    }
+}
+
+const fm_station_record_t *fm_station_db_find(const fm_station_db_t *db, uint16_t frequency) {
+    size_t index = fm_station_db_lower_bound(db, frequency);
+    if (index < db->count && db->stations[index].frequency == frequency) {
+        return &db->stations[index];
+    }
+    return NULL;
+}
+
+const fm_station_record_t *fm_station_db_find_pi(const fm_station_db_t *db, uint16_t pi) {
+    assert(pi != 0);
+
+    for (size_t i = 0; i < db->count; i++) {
+        if (db->stations[i].pi == pi) {
+            return &db->stations[i];
+        }
+    }
+    return NULL;
+}
+
+bool fm_station_db_update(fm_station_db_t *db, uint16_t frequency, uint8_t rssi, const rds_parser_t *parser) {
+    fm_station_record_t *record = fm_station_db_get_or_insert(db, frequency, rssi);
+    if (record == NULL) {
+        return false;
+    }
+    if (parser != NULL) {
+        fm_station_db_update_rds(db, record, parser);
+    }
+    return true;
+}
+
+void fm_station_db_update_from_scan(fm_station_db_t *db, const fm_scan_station_t *stations, size_t count) {
+    for (size_t i = 0; i < count; i++) {
+        fm_station_record_t *record = fm_station_db_get_or_insert(db, stations[i].frequency, stations[i].rssi);
+        if (record != NULL && stations[i].pi != 0 && record->pi != stations[i].pi) {
+            if (record->pi != 0) {
+                // another station now, the stored name and AFs are stale
+                memset(record->ps, 0, sizeof(record->ps));
+                record->alt_freq_count = 0;
+            }
+            record->pi = stations[i].pi;
+            db->dirty = true;
+        }
+    }
+}
+
+bool fm_station_db_remove(fm_station_db_t *db, uint16_t frequency) {
+    size_t index = fm_station_db_lower_bound(db, frequency);
+    if (index < db->count && db->stations[index].frequency == frequency) {
+        fm_station_db_erase_at(db, index);
+        return true;
+    }
+    return false;
+}
+
+void fm_station_db_restore(const fm_station_record_t *record, rds_parser_t *parser) {
+    parser->pi = record->pi;
+    if (record->ps[0] != '\0') {
+        memcpy(parser->ps_str, record->ps, sizeof(record->ps));
+        parser->ps_str[8] = '\0';
+    }
+#if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+    for (size_t i = 0; i < record->alt_freq_count; i++) {
+        uint8_t alt_freq = record->alt_freqs[i];
+        if (alt_freq == 0 || 205 <= alt_freq || rds_has_alternative_frequency(parser, alt_freq)) {
+            continue;
+        }
+        parser->alt_freq_bitmap[alt_freq / 32] |= 1u << (alt_freq % 32);
+        parser->alt_freq_count++;
+    }
+#endif
+}
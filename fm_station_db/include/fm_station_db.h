@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_STATION_DB_H_
+#define _FM_STATION_DB_H_
+
+#include <fm_si470x.h>
+#include <hardware/flash.h>
+#include <rds_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_station_db.h
+ *
+ * \brief Station database persisted in flash.
+ *
+ * Keeps the frequency, PI, PS name, last RSSI and AF list of known stations, so they
+ * survive a restart. After tuning to a known station, fm_station_db_restore() fills in
+ * the RDS parser right away, and the name is shown before any RDS group has arrived.
+ *
+ * The database lives in RAM and is written to flash only by fm_station_db_save(). Each
+ * save goes to the next slot of a ring spanning FM_STATION_DB_SECTORS sectors, and a
+ * sector is only erased when the ring wraps into it, spreading wear across the region.
+ * On load, the valid slot with the highest sequence number wins, so an interrupted save
+ * falls back to the previous one.
+ *
+ * Usage:
+ *
+ *     fm_station_db_init(&station_db);
+ *     fm_power_up(&radio, fm_config_europe());
+ *     ...
+ *     fm_set_frequency_10khz_blocking(&radio, frequency);
+ *     rds_parser_reset(&rds_parser);
+ *     const fm_station_record_t *record = fm_station_db_find(&station_db, frequency);
+ *     if (record != NULL) {
+ *         fm_station_db_restore(record, &rds_parser);
+ *     }
+ */
+
+#ifndef FM_STATION_DB_CAPACITY
+#define FM_STATION_DB_CAPACITY 32
+#endif
+
+#ifndef FM_STATION_DB_MAX_ALT_FREQS
+#define FM_STATION_DB_MAX_ALT_FREQS 18 // pads a record to 32 bytes
+#endif
+
+#ifndef FM_STATION_DB_SECTORS
+#define FM_STATION_DB_SECTORS 2
+#endif
+
+/**
+ * \brief Flash offset of the database region, by default the last sectors of flash.
+ *
+ * Must be sector aligned and must not overlap the program image.
+ */
+#ifndef FM_STATION_DB_FLASH_OFFSET
+#define FM_STATION_DB_FLASH_OFFSET (PICO_FLASH_SIZE_BYTES - FM_STATION_DB_SECTORS * FLASH_SECTOR_SIZE)
+#endif
+
+/**
+ * \brief Stored station.
+ */
+typedef struct fm_station_record_t
+{
+    uint16_t frequency; /**< Frequency in 10 kHz units. */
+    uint16_t pi; /**< RDS program identification, 0 if unknown. */
+    char ps[8]; /**< RDS program service name, not null terminated. Empty if unknown. */
+    uint8_t rssi; /**< RSSI when last updated. */
+    uint8_t alt_freq_count; /**< Number of alt_freqs. */
+    uint8_t alt_freqs[FM_STATION_DB_MAX_ALT_FREQS]; /**< Raw AF values in ascending order. */
+} fm_station_record_t;
+
+/**
+ * \brief Station database.
+ */
+typedef struct fm_station_db_t
+{
+    fm_station_record_t stations[FM_STATION_DB_CAPACITY]; // sorted by frequency
+    uint16_t count;
+    bool dirty; // changed since the last load / save
+    uint32_t sequence; // of the last loaded / saved slot
+    uint16_t slot; // last loaded / saved slot
+} fm_station_db_t;
+
+/**
+ * \brief Load the database from flash.
+ *
+ * Starts empty if no valid copy is found.
+ *
+ * @param db Station database.
+ * @return true Loaded from flash.
+ * @return false No valid copy.
+ */
+bool fm_station_db_init(fm_station_db_t *db);
+
+/**
+ * \brief Write the database to flash, if changed.
+ *
+ * Interrupts are disabled while the flash is programmed, up to tens of milliseconds when a
+ * sector must be erased. Code running on the other core must not execute from flash in the
+ * meantime, e.g. lock it out with multicore_lockout_start_blocking(). Avoid calling while the
+ * radio is used from an IRQ.
+ *
+ * RSSI-only updates don't mark the database as changed, so they are persisted with the next
+ * meaningful change.
+ *
+ * @param db Station database.
+ */
+void fm_station_db_save(fm_station_db_t *db);
+
+/**
+ * \brief Remove all stations. Persisted by the next fm_station_db_save().
+ *
+ * @param db Station database.
+ */
+void fm_station_db_clear(fm_station_db_t *db);
+
+/**
+ * \brief Get the number of stations.
+ *
+ * @param db Station database.
+ */
+static inline size_t fm_station_db_count(const fm_station_db_t *db) {
+    return db->count;
+}
+
+/**
+ * \brief Get a station, in ascending frequency order.
+ *
+ * @param db Station database.
+ * @param index Station index, less than fm_station_db_count().
+ */
+static inline const fm_station_record_t *fm_station_db_get(const fm_station_db_t *db, size_t index) {
+    assert(index < db->count);
+
+    return &db->stations[index];
+}
+
+/**
+ * \brief Find a station by frequency.
+ *
+ * @param db Station database.
+ * @param frequency Frequency in 10 kHz units.
+ * @return Station, or NULL if unknown.
+ */
+const fm_station_record_t *fm_station_db_find(const fm_station_db_t *db, uint16_t frequency);
+
+/**
+ * \brief Find a station by RDS PI code, e.g. to check an alternative frequency.
+ *
+ * @param db Station database.
+ * @param pi PI code, not 0.
+ * @return First station with this PI, or NULL if unknown.
+ */
+const fm_station_record_t *fm_station_db_find_pi(const fm_station_db_t *db, uint16_t pi);
+
+/**
+ * \brief Add a station, or update its RSSI and the RDS fields known to the parser.
+ *
+ * Fields the parser hasn't received yet keep their stored values. If the database is full,
+ * the weakest station is replaced, unless the new one is weaker still.
+ *
+ * @param db Station database.
+ * @param frequency Frequency in 10 kHz units.
+ * @param rssi Current RSSI.
+ * @param parser RDS parser of the station, or NULL.
+ * @return true Stored.
+ * @return false Database full of stronger stations.
+ */
+bool fm_station_db_update(fm_station_db_t *db, uint16_t frequency, uint8_t rssi, const rds_parser_t *parser);
+
+/**
+ * \brief Add or update stations found by fm_scan_blocking() / fm_scan_async().
+ *
+ * @param db Station database.
+ * @param stations Scan results.
+ * @param count Number of stations.
+ */
+void fm_station_db_update_from_scan(fm_station_db_t *db, const fm_scan_station_t *stations, size_t count);
+
+/**
+ * \brief Remove a station.
+ *
+ * @param db Station database.
+ * @param frequency Frequency in 10 kHz units.
+ * @return true Removed.
+ * @return false Unknown station.
+ */
+bool fm_station_db_remove(fm_station_db_t *db, uint16_t frequency);
+
+/**
+ * \brief Fill an RDS parser with the stored PI, PS name and AF list.
+ *
+ * Call after rds_parser_reset(). Received groups overwrite the restored values as usual.
+ * If the first PI received differs from the stored one (RDS_CHANGE_PI), the frequency now
+ * carries a different station, so the parser should be reset again.
+ *
+ * @param record Stored station.
+ * @param parser RDS parser.
+ */
+void fm_station_db_restore(const fm_station_record_t *record, rds_parser_t *parser);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_STATION_DB_H_
@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_ta_monitor.h>
+#include <hardware/sync.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+//
+// group decoding
+//
+
+static bool fm_ta_monitor_decode(fm_ta_monitor_t *monitor, const uint16_t *blocks, const uint8_t *bler, bool *announcement) {
+    // Only block B is decoded: group type, TP and TA. Returns false for groups without TA, or
+    // without a valid PI of the monitored station.
+    if (bler[1] == 3) {
+        return false; // group type unknown
+    }
+    uint16_t b = blocks[1];
+    uint8_t type = b >> 12;
+    bool version_b = ((b >> 11) & 0x1) != 0;
+    if (!(type == 0 || (type == 15 && version_b))) {
+        return false; // TA is only in 0A, 0B and 15B
+    }
+    // version B groups repeat PI in block C
+    uint16_t pi;
+    if (bler[0] < 3) {
+        pi = blocks[0];
+    } else if (version_b && bler[2] < 3) {
+        pi = blocks[2];
+    } else {
+        return false;
+    }
+    if (monitor->pi == 0) {
+        monitor->pi = pi;
+    } else if (pi != monitor->pi) {
+        return false;
+    }
+    bool tp = ((b >> 10) & 0x1) != 0;
+    bool ta = ((b >> 4) & 0x1) != 0;
+    *announcement = tp && ta; // TA without TP refers to another network
+    return true;
+}
+
+static fm_ta_event_t fm_ta_monitor_update(fm_ta_monitor_t *monitor, bool announcement) {
+    if (announcement == monitor->announcement) {
+        monitor->confirm_count = 0;
+        return FM_TA_NONE;
+    }
+    if (++monitor->confirm_count < FM_TA_MONITOR_CONFIRM_GROUPS) {
+        return FM_TA_NONE;
+    }
+    monitor->confirm_count = 0;
+    monitor->announcement = announcement;
+    return announcement ? FM_TA_STARTED : FM_TA_ENDED;
+}
+
+static int64_t fm_ta_monitor_alarm_callback(alarm_id_t id, void *user_data) {
+    (void)id;
+    fm_ta_monitor_t *monitor = user_data;
+    monitor->timed_out = true;
+    return 0; // don't reschedule
+}
+
+static void fm_ta_monitor_sleep(fm_ta_monitor_t *monitor) {
+    // With interrupts disabled, WFI still wakes on a pending interrupt, so one arriving
+    // between the check and WFI isn't missed. The handler runs once interrupts are restored.
+    uint32_t irq_state = save_and_disable_interrupts();
+    if (!monitor->radio->irq_rds_pending && !monitor->timed_out) {
+        __wfi();
+    }
+    restore_interrupts(irq_state);
+}
+
+//
+// public interface
+//
+
+void fm_ta_monitor_init(fm_ta_monitor_t *monitor, si470x_t *radio) {
+    memset(monitor, 0, sizeof(fm_ta_monitor_t));
+
+    monitor->radio = radio;
+}
+
+void fm_ta_monitor_enter(fm_ta_monitor_t *monitor, uint16_t pi) {
+    si470x_t *radio = monitor->radio;
+    assert(!monitor->active);
+    assert(fm_is_powered_up(radio));
+    assert(fm_is_rds_supported(radio));
+    assert(radio->irq_enabled); // see fm_enable_interrupts()
+    assert(radio->async.task == NULL); // disallowed during async task
+
+    monitor->pi = pi;
+    monitor->active = true;
+    monitor->was_muted = fm_get_mute(radio);
+    monitor->announcement = false;
+    monitor->confirm_count = 0;
+    monitor->group_count = 0;
+    fm_set_mute(radio, true);
+}
+
+void fm_ta_monitor_exit(fm_ta_monitor_t *monitor) {
+    assert(monitor->active);
+
+    monitor->active = false;
+    fm_set_mute(monitor->radio, monitor->was_muted);
+}
+
+fm_ta_event_t fm_ta_monitor_poll(fm_ta_monitor_t *monitor) {
+    assert(monitor->active);
+
+    uint16_t blocks[4];
+    uint8_t bler[4];
+    if (!fm_read_rds_group_with_errors(monitor->radio, blocks, bler)) {
+        return FM_TA_NONE; // no interrupt since last read
+    }
+    bool announcement;
+    if (!fm_ta_monitor_decode(monitor, blocks, bler, &announcement)) {
+        return FM_TA_NONE;
+    }
+    monitor->group_count++;
+    return fm_ta_monitor_update(monitor, announcement);
+}
+
+fm_ta_event_t fm_ta_monitor_wait(fm_ta_monitor_t *monitor, uint32_t timeout_ms) {
+    assert(monitor->active);
+
+    // the alarm interrupt wakes the core on timeout, even if the station has no RDS
+    monitor->timed_out = false;
+    alarm_id_t alarm_id = add_alarm_in_ms(timeout_ms, fm_ta_monitor_alarm_callback, monitor, true);
+    if (alarm_id <= 0) {
+        monitor->timed_out = true; // already due or no alarm slot, check once
+    }
+    fm_ta_event_t event;
+    while ((event = fm_ta_monitor_poll(monitor)) == FM_TA_NONE && !monitor->timed_out) {
+        fm_ta_monitor_sleep(monitor);
+    }
+    if (alarm_id > 0) {
+        cancel_alarm(alarm_id); // no effect if already fired
+    }
+    return event;
+}
@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_TA_MONITOR_H_
+#define _FM_TA_MONITOR_H_
+
+#include <fm_si470x.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_ta_monitor.h
+ *
+ * \brief Low-power standby for traffic announcements.
+ *
+ * Mutes the radio, keeps it tuned with RDS enabled, and sleeps the core until the GPIO2
+ * interrupt signals an RDS group. Each group is checked for the TP / TA flags only (groups
+ * 0A, 0B and 15B), without running the full RDS parser, and the core goes back to sleep
+ * until an announcement starts or ends. Between groups, roughly 11 per second, the core
+ * waits in WFI instead of polling the bus.
+ *
+ * Requires fm_enable_interrupts(). Groups read by the monitor don't reach the application's
+ * RDS parser, so it may be stale on return. No async task may run while monitoring.
+ *
+ * Usage:
+ *
+ *     fm_ta_monitor_enter(&ta_monitor, rds_get_program_id(&rds_parser));
+ *     while (fm_ta_monitor_wait(&ta_monitor, 1000) != FM_TA_STARTED) {
+ *     }
+ *     fm_ta_monitor_exit(&ta_monitor);
+ *     fm_set_mute(&radio, false);
+ */
+
+/** Consecutive groups needed to accept a TA change, so a single bad group doesn't toggle it. */
+#ifndef FM_TA_MONITOR_CONFIRM_GROUPS
+#define FM_TA_MONITOR_CONFIRM_GROUPS 2
+#endif
+
+/**
+ * \brief Traffic announcement events.
+ */
+typedef enum fm_ta_event_t
+{
+    FM_TA_NONE,
+    FM_TA_STARTED, /**< Traffic announcement on air (TP and TA set). */
+    FM_TA_ENDED, /**< Traffic announcement finished. */
+} fm_ta_event_t;
+
+/**
+ * \brief Traffic announcement monitor.
+ */
+typedef struct fm_ta_monitor_t
+{
+    si470x_t *radio;
+    uint16_t pi; // groups of other stations are ignored, 0 to accept the first seen
+    bool active;
+    bool was_muted;
+    bool announcement;
+    uint8_t confirm_count; // groups disagreeing with announcement
+    volatile bool timed_out;
+    uint32_t group_count; /**< TA groups checked since entering. */
+} fm_ta_monitor_t;
+
+/**
+ * \brief Initialize the monitor.
+ *
+ * @param monitor Monitor.
+ * @param radio Radio handle.
+ */
+void fm_ta_monitor_init(fm_ta_monitor_t *monitor, si470x_t *radio);
+
+/**
+ * \brief Mute the radio and start monitoring the tuned station.
+ *
+ * @param monitor Monitor.
+ * @param pi PI code of the station, e.g. from rds_get_program_id(), or 0 to take the first
+ *   one received.
+ */
+void fm_ta_monitor_enter(fm_ta_monitor_t *monitor, uint16_t pi);
+
+/**
+ * \brief Stop monitoring, restoring the mute setting from before fm_ta_monitor_enter().
+ *
+ * @param monitor Monitor.
+ */
+void fm_ta_monitor_exit(fm_ta_monitor_t *monitor);
+
+/**
+ * \brief Check a pending RDS group without sleeping.
+ *
+ * @param monitor Monitor.
+ * @return Event, if the group confirmed a change.
+ */
+fm_ta_event_t fm_ta_monitor_poll(fm_ta_monitor_t *monitor);
+
+/**
+ * \brief Sleep until a traffic announcement starts or ends.
+ *
+ * The core sleeps in WFI and only wakes on interrupts. Other interrupts, e.g. from USB,
+ * briefly wake it as well.
+ *
+ * @param monitor Monitor.
+ * @param timeout_ms Maximum time to wait.
+ * @return Event, or FM_TA_NONE on timeout.
+ */
+fm_ta_event_t fm_ta_monitor_wait(fm_ta_monitor_t *monitor, uint32_t timeout_ms);
+
+/**
+ * \brief Check whether a traffic announcement is on air.
+ *
+ * @param monitor Monitor.
+ */
+static inline bool fm_ta_monitor_is_announcement(const fm_ta_monitor_t *monitor) {
+    return monitor->announcement;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_TA_MONITOR_H_
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <fm_rds.h>
+#include <fm_si470x.h>
+#include <fm_sim.h>
+#include <rds_parser.h>
+#include <rds_replay.h>
+#include <pico/stdlib.h>
+#include <inttypes.h>
+#include <stdio.h>
+
+// Host counterpart of fm_benchmark.c, running the driver against the simulator. Results are
+// printed as CSV on stdout:
+//
+//   parse,<source>,groups,ns_per_group
+//   seek,seeks,min_ms,avg_ms,max_ms,stations
+//   acquire_<field>,<scenario>,tunes,min_ms,avg_ms,max_ms,timeouts
+//
+// Parser throughput is measured in wall-clock time. Acquisition latency is the virtual time
+// from the start of tuning until PI, PS and radio text are complete, with the driver polling
+// RDS like fm_example.c.
+//
+// Usage: fm_host_benchmark [capture.bin|groups.txt]
+
+static const uint RESET_PIN = 15;
+static const uint SDIO_PIN = 4;
+static const uint SCLK_PIN = 5;
+
+static const uint RDS_POLL_INTERVAL_MS = 40;
+static const uint ACQUIRE_TIMEOUT_MS = 10 * 1000;
+static const uint ACQUIRE_TUNES = 32;
+static const uint PARSE_GROUPS = 1000 * 1000;
+
+static const uint16_t ALT_FREQS_A[] = {8880, 9500, 10210};
+static const uint16_t ALT_FREQS_B[] = {9110, 10010, 10430, 10650, 10770};
+
+static rds_replay_t replay_a;
+static rds_replay_t replay_b;
+
+static fm_sim_station_t stations[] = {
+    {8880, 45, true, 0, &replay_a},
+    {9500, 30, true, 0, &replay_a},
+    {10100, 50, true, 0, &replay_b},
+    {10420, 40, false, 0, NULL},
+    {10650, 20, false, 0, NULL}, // too weak for seek
+};
+
+#define FM_CONFIG fm_config_europe()
+
+static fm_sim_t sim;
+static si470x_t radio;
+static rds_parser_t rds_parser;
+
+//
+// parser throughput
+//
+
+static void bench_parse(const char *source, rds_replay_t *replay) {
+    rds_parser_reset(&rds_parser);
+    rds_replay_rewind(replay);
+    uint64_t start = pico_host_wall_time_ns();
+    for (uint i = 0; i < PARSE_GROUPS; i++) {
+        const rds_group_entry_t *entry = rds_replay_next(replay);
+        rds_parser_update_with_errors(&rds_parser, &entry->group, entry->bler);
+    }
+    uint64_t elapsed = pico_host_wall_time_ns() - start;
+    printf("parse,%s,%u,%.1f\n", source, PARSE_GROUPS, (double)elapsed / PARSE_GROUPS);
+}
+
+//
+// acquisition latency
+//
+
+typedef struct acquire_result_t
+{
+    uint64_t min_us;
+    uint64_t max_us;
+    uint64_t total_us;
+    uint count;
+    uint timeouts;
+} acquire_result_t;
+
+static void acquire_add(acquire_result_t *result, uint64_t elapsed_us, bool done) {
+    if (!done) {
+        result->timeouts++;
+        return;
+    }
+    result->min_us = MIN(result->min_us, elapsed_us);
+    result->max_us = MAX(result->max_us, elapsed_us);
+    result->total_us += elapsed_us;
+    result->count++;
+}
+
+static void acquire_print(const char *field, const char *scenario, const acquire_result_t *result) {
+    uint count = MAX(result->count, 1u);
+    printf("acquire_%s,%s,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u\n",
+        field,
+        scenario,
+        result->count + result->timeouts,
+        result->count != 0 ? result->min_us / 1000 : 0,
+        result->total_us / count / 1000,
+        result->max_us / 1000,
+        result->timeouts);
+}
+
+static void bench_seek(void) {
+    // one full pass over the band, wrapping around to the first station
+    fm_set_frequency_10khz_blocking(&radio, 8750);
+    acquire_result_t result = {.min_us = UINT64_MAX};
+    uint found = 0;
+    for (size_t i = 0; i < count_of(stations); i++) {
+        uint64_t start = time_us_64();
+        bool success = fm_seek_blocking(&radio, FM_SEEK_UP);
+        acquire_add(&result, time_us_64() - start, true);
+        found += success;
+    }
+    printf("seek,%u,%" PRIu64 ",%" PRIu64 ",%" PRIu64 ",%u\n",
+        result.count,
+        result.min_us / 1000,
+        result.total_us / result.count / 1000,
+        result.max_us / 1000,
+        found);
+}
+
+static void bench_acquire(const char *scenario, uint8_t block_error_percent, bool rds_verbose) {
+    for (size_t i = 0; i < count_of(stations); i++) {
+        stations[i].block_error_percent = block_error_percent;
+    }
+    fm_set_rds_verbose(&radio, rds_verbose);
+
+    acquire_result_t pi = {.min_us = UINT64_MAX};
+    acquire_result_t ps = {.min_us = UINT64_MAX};
+    acquire_result_t rt = {.min_us = UINT64_MAX};
+    for (uint i = 0; i < ACQUIRE_TUNES; i++) {
+        // alternate between stations with different RDS data
+        uint16_t frequency = stations[(i % 2) * 2].frequency;
+        uint64_t start = time_us_64();
+        fm_set_frequency_10khz_blocking(&radio, frequency);
+        rds_parser_reset(&rds_parser);
+        rds_parser_set_tuned_frequency_10khz(&rds_parser, frequency);
+
+        uint64_t pi_time = 0;
+        uint64_t ps_time = 0;
+        uint64_t rt_time = 0;
+        while ((pi_time == 0 || ps_time == 0 || rt_time == 0) && time_us_64() - start < ACQUIRE_TIMEOUT_MS * 1000ull) {
+            uint32_t changes;
+            if (fm_read_and_parse_rds(&radio, &rds_parser, &changes)) {
+                uint64_t now = time_us_64();
+                if ((changes & RDS_CHANGE_PI) && pi_time == 0) {
+                    pi_time = now;
+                }
+                if ((changes & RDS_CHANGE_PS) && ps_time == 0) {
+                    ps_time = now;
+                }
+                if ((changes & RDS_CHANGE_RT) && rt_time == 0) {
+                    rt_time = now;
+                }
+            }
+            sleep_ms(RDS_POLL_INTERVAL_MS);
+        }
+        acquire_add(&pi, pi_time - start, pi_time != 0);
+        acquire_add(&ps, ps_time - start, ps_time != 0);
+        acquire_add(&rt, rt_time - start, rt_time != 0);
+    }
+    acquire_print("pi", scenario, &pi);
+    acquire_print("ps", scenario, &ps);
+    acquire_print("rt", scenario, &rt);
+}
+
+//
+// main
+//
+
+int main(int argc, char **argv) {
+    rds_replay_init(&replay_a);
+    rds_replay_synthesize(&replay_a, &(rds_replay_station_t){
+        .pi = 0xE2B5,
+        .pty = 10,
+        .ps = "RADIO A",
+        .rt = "Now playing: a rather long song title by an artist",
+        .alt_freqs = ALT_FREQS_A,
+        .alt_freq_count = count_of(ALT_FREQS_A),
+    });
+    rds_replay_init(&replay_b);
+    rds_replay_synthesize(&replay_b, &(rds_replay_station_t){
+        .pi = 0xC201,
+        .pty = 3,
+        .tp = true,
+        .ps = "NEWS B",
+        .rt = "Traffic on the ring road",
+        .alt_freqs = ALT_FREQS_B,
+        .alt_freq_count = count_of(ALT_FREQS_B),
+    });
+
+    printf("op,source,groups,ns_per_group\n");
+    bench_parse("synthesized", &replay_a);
+    if (argc > 1) {
+        rds_replay_t capture;
+        rds_replay_init(&capture);
+        if (rds_replay_load(&capture, argv[1]) <= 0) {
+            fprintf(stderr, "no RDS groups in %s\n", argv[1]);
+            return 1;
+        }
+        bench_parse(argv[1], &capture);
+        rds_replay_free(&capture);
+    }
+
+    fm_sim_init(&sim, stations, count_of(stations));
+    fm_init(&radio, NULL, RESET_PIN, SDIO_PIN, SCLK_PIN, false);
+    fm_set_transport(&radio, &fm_sim_transport, &sim);
+    fm_power_up(&radio, FM_CONFIG);
+
+    printf("op,seeks,min_ms,avg_ms,max_ms,stations\n");
+    bench_seek();
+
+    printf("op,scenario,tunes,min_ms,avg_ms,max_ms,timeouts\n");
+    bench_acquire("clean", 0, false);
+    bench_acquire("errors_5", 5, false);
+    bench_acquire("errors_5_verbose", 5, true);
+    bench_acquire("errors_20", 20, false);
+    bench_acquire("errors_20_verbose", 20, true);
+
+    fm_power_down(&radio);
+    rds_replay_free(&replay_a);
+    rds_replay_free(&replay_b);
+    return 0;
+}
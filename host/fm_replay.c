@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <rds_parser.h>
+#include <rds_replay.h>
+#include <stdio.h>
+
+// Feeds a recorded capture to the RDS parser and prints each field change, with the group
+// index and reception time. Useful to reproduce field reports offline. Takes a binary
+// rds_capture stream, as recorded with the example's 'c' command, or a text capture.
+//
+// Usage: fm_replay <capture.bin|groups.txt>
+
+static rds_parser_t rds_parser;
+
+static void print_changes(size_t index, const rds_group_entry_t *entry, uint32_t changes) {
+    double time_s = entry->timestamp_us / 1e6;
+    if (changes & RDS_CHANGE_PI) {
+        char pi_str[5];
+        rds_get_program_id_as_str(&rds_parser, pi_str);
+        printf("%6zu %8.2fs PI  %s\n", index, time_s, pi_str);
+    }
+    if (changes & RDS_CHANGE_PTY) {
+        printf("%6zu %8.2fs PTY %u\n", index, time_s, rds_get_program_type(&rds_parser));
+    }
+    if (changes & (RDS_CHANGE_TP | RDS_CHANGE_TA)) {
+        printf("%6zu %8.2fs TP  %u, TA %u\n", index, time_s,
+            rds_has_traffic_program(&rds_parser), rds_has_traffic_announcement(&rds_parser));
+    }
+    if (changes & RDS_CHANGE_PS) {
+        printf("%6zu %8.2fs PS  \"%s\"\n", index, time_s, rds_get_program_service_name_str(&rds_parser));
+    }
+#if RDS_PARSER_RADIO_TEXT_ENABLE
+    if (changes & RDS_CHANGE_RT) {
+        printf("%6zu %8.2fs RT  \"%s\"\n", index, time_s, rds_get_radio_text_str(&rds_parser));
+    }
+#endif
+#if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+    if (changes & RDS_CHANGE_AF) {
+        printf("%6zu %8.2fs AF ", index, time_s);
+        size_t count = rds_get_alternative_frequency_count(&rds_parser);
+        for (size_t i = 0; i < count; i++) {
+            printf(" %.1f", rds_decode_alternative_frequency(rds_get_alternative_frequency(&rds_parser, i)));
+        }
+        printf("\n");
+    }
+#endif
+}
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <capture.bin|groups.txt>\n", argv[0]);
+        return 2;
+    }
+    rds_replay_t replay;
+    rds_replay_init(&replay);
+    if (rds_replay_load(&replay, argv[1]) <= 0) {
+        fprintf(stderr, "no RDS groups in %s\n", argv[1]);
+        return 1;
+    }
+
+    rds_parser_reset(&rds_parser);
+    size_t corrupted = 0;
+    for (size_t i = 0; i < replay.count; i++) {
+        const rds_group_entry_t *entry = rds_replay_next(&replay);
+        for (size_t j = 0; j < 4; j++) {
+            if (entry->bler[j] == 3) {
+                corrupted++;
+                break;
+            }
+        }
+        uint32_t changes = rds_parser_update_with_errors(&rds_parser, &entry->group, entry->bler);
+        print_changes(i, entry, changes);
+    }
+    printf("%zu groups, %zu with uncorrectable blocks\n", replay.count, corrupted);
+
+    rds_replay_free(&replay);
+    return 0;
+}
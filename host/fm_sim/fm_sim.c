@@ -0,0 +1,332 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "fm_si470x_regs.h"
+#include <fm_sim.h>
+#include <pico/stdlib.h>
+#include <string.h>
+
+#define DEVICEID_SI470X 0x1242
+#define CHIPID_SI4702 0x1053 // rev C, firmware 19
+#define CHIPID_SI4703 0x1253
+
+static const uint32_t TUNE_TIME_US = 60 * 1000;
+static const uint32_t RDSR_HOLD_US = 40 * 1000;
+static const uint8_t NOISE_RSSI = 10;
+
+//
+// band
+//
+
+static uint8_t fm_sim_band(fm_sim_t *sim) {
+    return (sim->regs[SYSCONFIG2] & BAND_BITS) >> BAND_LSB;
+}
+
+static uint16_t fm_sim_spacing(fm_sim_t *sim) {
+    switch ((sim->regs[SYSCONFIG2] >> SPACE_LSB) & 0x3) {
+    case 0:
+        return 20;
+    case 1:
+        return 10;
+    default:
+        return 5;
+    }
+}
+
+static uint16_t fm_sim_bottom(fm_sim_t *sim) {
+    return fm_sim_band(sim) == 0 ? 8750 : 7600;
+}
+
+static uint16_t fm_sim_top(fm_sim_t *sim) {
+    return fm_sim_band(sim) == 2 ? 9000 : 10800;
+}
+
+static uint16_t fm_sim_channel_count(fm_sim_t *sim) {
+    return (fm_sim_top(sim) - fm_sim_bottom(sim)) / fm_sim_spacing(sim) + 1;
+}
+
+static const fm_sim_station_t *fm_sim_station_at(fm_sim_t *sim, uint16_t channel) {
+    uint16_t frequency = fm_sim_bottom(sim) + channel * fm_sim_spacing(sim);
+    for (size_t i = 0; i < sim->station_count; i++) {
+        if (sim->stations[i].frequency == frequency) {
+            return &sim->stations[i];
+        }
+    }
+    return NULL;
+}
+
+static uint8_t fm_sim_rssi_at(fm_sim_t *sim, uint16_t channel) {
+    const fm_sim_station_t *station = fm_sim_station_at(sim, channel);
+    return station != NULL ? station->rssi : sim->noise_rssi;
+}
+
+//
+// status registers
+//
+
+static void fm_sim_set_status(fm_sim_t *sim, uint16_t clear_bits, uint16_t set_bits) {
+    sim->regs[STATUSRSSI] = (sim->regs[STATUSRSSI] & ~clear_bits) | set_bits;
+}
+
+static void fm_sim_set_channel(fm_sim_t *sim, uint16_t channel) {
+    sim->regs[READCHAN] = (sim->regs[READCHAN] & ~READCHAN_BITS) | channel;
+}
+
+static void fm_sim_stop_rds(fm_sim_t *sim) {
+    sim->station = NULL;
+    sim->rdsr_time = 0;
+    sim->regs[READCHAN] &= READCHAN_BITS; // clear BLER
+    fm_sim_set_status(sim, RDSR_BIT | RDSS_BIT | BLERA_BITS, 0);
+}
+
+static void fm_sim_receive(fm_sim_t *sim, uint16_t channel, uint64_t now) {
+    // tune or seek complete, report the signal on the channel
+    const fm_sim_station_t *station = fm_sim_station_at(sim, channel);
+    uint16_t status = fm_sim_rssi_at(sim, channel) << RSSI_LSB;
+    if (station != NULL && station->stereo && !(sim->regs[POWERCFG] & MONO_BIT)) {
+        status |= ST_BIT;
+    }
+    sim->regs[STATUSRSSI] = status;
+    fm_sim_set_channel(sim, channel);
+    sim->station = station;
+    // the first group starts at an arbitrary point of the transmission
+    sim->next_group_time = now + sim->random % sim->group_interval_us;
+}
+
+//
+// tune / seek
+//
+
+static void fm_sim_start_tune(fm_sim_t *sim, uint64_t now) {
+    fm_sim_stop_rds(sim);
+    fm_sim_set_status(sim, STC_BIT | SFBL_BIT, 0);
+    sim->operation = FM_SIM_TUNING;
+    sim->operation_start = now;
+    sim->operation_end = now + sim->tune_time_us;
+    sim->end_channel = (sim->regs[CHANNEL] & CHAN_BITS) % fm_sim_channel_count(sim);
+}
+
+static void fm_sim_start_seek(fm_sim_t *sim, uint64_t now) {
+    // find where the seek ends, progress is reported lazily
+    uint16_t count = fm_sim_channel_count(sim);
+    uint16_t start = sim->regs[READCHAN] & READCHAN_BITS;
+    uint8_t seekth = sim->regs[SYSCONFIG2] >> SEEKTH_LSB;
+    bool wrap = !(sim->regs[POWERCFG] & SKMODE_BIT);
+    sim->seek_up = (sim->regs[POWERCFG] & SEEKUP_BIT) != 0;
+    sim->seek_failed = true;
+
+    uint16_t channel = start;
+    uint32_t steps = 0;
+    while (steps < count - 1u) {
+        if (!wrap && channel == (sim->seek_up ? count - 1 : 0)) {
+            break; // band limit
+        }
+        channel = sim->seek_up ? (channel + 1) % count : (channel + count - 1) % count;
+        steps++;
+        if (seekth <= fm_sim_rssi_at(sim, channel) && fm_sim_station_at(sim, channel) != NULL) {
+            sim->seek_failed = false;
+            break;
+        }
+    }
+    if (sim->seek_failed && wrap) {
+        channel = start; // went all the way around
+        steps = count;
+    }
+
+    fm_sim_stop_rds(sim);
+    fm_sim_set_status(sim, STC_BIT | SFBL_BIT, 0);
+    sim->operation = FM_SIM_SEEKING;
+    sim->operation_start = now;
+    sim->operation_end = now + (uint64_t)MAX(steps, 1u) * sim->tune_time_us;
+    sim->start_channel = start;
+    sim->end_channel = channel;
+}
+
+static void fm_sim_update_operation(fm_sim_t *sim, uint64_t now) {
+    if (sim->operation == FM_SIM_IDLE) {
+        return;
+    }
+    if (now < sim->operation_end) {
+        if (sim->operation == FM_SIM_SEEKING) {
+            // READCHAN follows the seek
+            uint16_t count = fm_sim_channel_count(sim);
+            uint16_t steps = (uint16_t)((now - sim->operation_start) / sim->tune_time_us % count);
+            uint16_t channel = sim->seek_up ? (sim->start_channel + steps) % count : (sim->start_channel + count - steps) % count;
+            fm_sim_set_channel(sim, channel);
+        }
+        return;
+    }
+    fm_sim_receive(sim, sim->end_channel, sim->operation_end);
+    fm_sim_set_status(sim, 0, STC_BIT | ((sim->operation == FM_SIM_SEEKING && sim->seek_failed) ? SFBL_BIT : 0));
+    sim->operation = FM_SIM_IDLE;
+}
+
+static void fm_sim_end_operation(fm_sim_t *sim, uint64_t now) {
+    // TUNE / SEEK bit cleared, possibly before completion
+    fm_sim_update_operation(sim, now);
+    if (sim->operation != FM_SIM_IDLE) {
+        fm_sim_receive(sim, sim->regs[READCHAN] & READCHAN_BITS, now); // stays where the seek got to
+        sim->operation = FM_SIM_IDLE;
+    }
+    fm_sim_set_status(sim, STC_BIT | SFBL_BIT, 0);
+}
+
+//
+// RDS
+//
+
+static uint32_t fm_sim_random(fm_sim_t *sim) {
+    sim->random = sim->random * 1664525u + 1013904223u;
+    return sim->random >> 8;
+}
+
+static void fm_sim_latch_group(fm_sim_t *sim, uint64_t time) {
+    const rds_group_entry_t *entry = rds_replay_next(sim->station->rds);
+    uint16_t blocks[4] = {entry->group.a, entry->group.b, entry->group.c, entry->group.d};
+    uint8_t bler[4];
+    bool corrupted = false;
+    for (size_t i = 0; i < 4; i++) {
+        bler[i] = entry->bler[i];
+        if (fm_sim_random(sim) % 100 < sim->station->block_error_percent) {
+            bler[i] = 3;
+            blocks[i] ^= (uint16_t)(fm_sim_random(sim) | 1);
+        }
+        corrupted = corrupted || bler[i] == 3;
+    }
+    sim->rds_groups++;
+    if (corrupted && !(sim->regs[POWERCFG] & RDSM_BIT)) {
+        sim->rds_groups_dropped++;
+        return;
+    }
+    memcpy(sim->regs + RDSA, blocks, sizeof(blocks));
+    fm_sim_set_status(sim, BLERA_BITS, RDSS_BIT | (bler[0] << BLERA_LSB));
+    sim->regs[READCHAN] = (sim->regs[READCHAN] & READCHAN_BITS)
+        | (bler[1] << BLERB_LSB) | (bler[2] << BLERC_LSB) | (bler[3] << BLERD_LSB);
+    sim->rdsr_time = time;
+}
+
+static void fm_sim_update_rds(fm_sim_t *sim, uint64_t now) {
+    bool enabled = (sim->regs[SYSCONFIG1] & RDS_BIT) && !sim->si4702;
+    if (sim->operation != FM_SIM_IDLE || sim->station == NULL || sim->station->rds == NULL
+        || sim->station->rds->count == 0 || !enabled) {
+        return;
+    }
+    // groups that weren't read in time are overwritten
+    for (; sim->next_group_time <= now; sim->next_group_time += sim->group_interval_us) {
+        fm_sim_latch_group(sim, sim->next_group_time);
+    }
+    bool ready = sim->rdsr_time != 0 && now - sim->rdsr_time < sim->rdsr_hold_us;
+    fm_sim_set_status(sim, RDSR_BIT, ready ? RDSR_BIT : 0);
+}
+
+static void fm_sim_update(fm_sim_t *sim, uint64_t now) {
+    fm_sim_update_operation(sim, now);
+    fm_sim_update_rds(sim, now);
+}
+
+//
+// transport
+//
+
+static void fm_sim_reset(fm_sim_t *sim) {
+    memset(sim->regs, 0, sizeof(sim->regs));
+    sim->regs[DEVICEID] = DEVICEID_SI470X;
+    sim->regs[CHIPID] = (sim->si4702 ? CHIPID_SI4702 : CHIPID_SI4703) & ~DEV_BITS; // DEV reads 0 until powered up
+    sim->operation = FM_SIM_IDLE;
+    sim->station = NULL;
+    sim->rdsr_time = 0;
+}
+
+static void fm_sim_init_pins(void *context, uint8_t sdio_pin, uint8_t sclk_pin, bool enable_pull_ups) {
+    (void)sdio_pin, (void)sclk_pin, (void)enable_pull_ups;
+    fm_sim_reset((fm_sim_t *)context); // called after the reset pulse
+}
+
+static bool fm_sim_read(void *context, uint8_t addr, uint8_t *dst, size_t len) {
+    fm_sim_t *sim = (fm_sim_t *)context;
+    if (addr != SI4703_ADDR) {
+        return false;
+    }
+    fm_sim_update(sim, time_us_64());
+    // read order: 0xA..0xF, 0x0..0x9
+    for (size_t i = 0; i < len; i++) {
+        uint16_t reg = sim->regs[(0xA + i / 2) % 16];
+        dst[i] = (i % 2 == 0) ? reg >> 8 : reg & 0xFF;
+    }
+    sim->reads++;
+    return true;
+}
+
+static bool fm_sim_write(void *context, uint8_t addr, const uint8_t *src, size_t len) {
+    fm_sim_t *sim = (fm_sim_t *)context;
+    if (addr != SI4703_ADDR) {
+        return false;
+    }
+    uint64_t now = time_us_64();
+    fm_sim_update(sim, now);
+
+    uint16_t old_powercfg = sim->regs[POWERCFG];
+    uint16_t old_channel = sim->regs[CHANNEL];
+    // write order: 0x2..0xF, status and RDS registers are read-only
+    for (size_t i = 0; i + 1 < len && 0x2 + i / 2 <= BOOTCONFIG; i += 2) {
+        sim->regs[0x2 + i / 2] = (src[i] << 8) | src[i + 1];
+    }
+    sim->writes++;
+
+    uint16_t powercfg = sim->regs[POWERCFG];
+    uint16_t channel = sim->regs[CHANNEL];
+    if ((powercfg & DISABLE_BIT) && !(old_powercfg & DISABLE_BIT)) {
+        sim->operation = FM_SIM_IDLE;
+        fm_sim_stop_rds(sim);
+        return true;
+    }
+    if ((powercfg & ENABLE_BIT) && (!(old_powercfg & ENABLE_BIT) || (old_powercfg & DISABLE_BIT))) {
+        sim->regs[CHIPID] = sim->si4702 ? CHIPID_SI4702 : CHIPID_SI4703;
+        fm_sim_receive(sim, sim->regs[READCHAN] & READCHAN_BITS, now);
+    }
+    if (!(powercfg & ENABLE_BIT) || (powercfg & DISABLE_BIT)) {
+        return true; // powered down
+    }
+    if ((channel & TUNE_BIT) && !(old_channel & TUNE_BIT)) {
+        fm_sim_start_tune(sim, now);
+    } else if (!(channel & TUNE_BIT) && (old_channel & TUNE_BIT)) {
+        fm_sim_end_operation(sim, now);
+    }
+    if ((powercfg & SEEK_BIT) && !(old_powercfg & SEEK_BIT)) {
+        fm_sim_start_seek(sim, now);
+    } else if (!(powercfg & SEEK_BIT) && (old_powercfg & SEEK_BIT)) {
+        fm_sim_end_operation(sim, now);
+    }
+    return true;
+}
+
+//
+// public interface
+//
+
+const fm_transport_t fm_sim_transport = {
+    .init_pins = fm_sim_init_pins,
+    .read = fm_sim_read,
+    .write = fm_sim_write,
+};
+
+void fm_sim_init(fm_sim_t *sim, const fm_sim_station_t *stations, size_t station_count) {
+    memset(sim, 0, sizeof(fm_sim_t));
+
+    sim->stations = stations;
+    sim->station_count = station_count;
+    sim->noise_rssi = NOISE_RSSI;
+    sim->tune_time_us = TUNE_TIME_US;
+    sim->group_interval_us = RDS_REPLAY_GROUP_INTERVAL_US;
+    sim->rdsr_hold_us = RDSR_HOLD_US;
+    sim->random = 1;
+    fm_sim_reset(sim);
+}
+
+const fm_sim_station_t *fm_sim_get_station(fm_sim_t *sim) {
+    fm_sim_update(sim, time_us_64());
+    return sim->operation == FM_SIM_IDLE ? sim->station : NULL;
+}
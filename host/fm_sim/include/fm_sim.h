@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _FM_SIM_H_
+#define _FM_SIM_H_
+
+#include <fm_si470x.h>
+#include <rds_replay.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file fm_sim.h
+ *
+ * \brief Simulated Si470x, for host builds.
+ *
+ * Plugs into the driver as a transport, and answers register reads and writes like the chip:
+ *
+ * - power up reports the Si4702 or Si4703 chip ID
+ * - tune sets STC after tune_time_us, with the RSSI and stereo flag of the station on that channel
+ * - seek walks the band one channel per tune_time_us, stopping at the first station with RSSI
+ *   above SEEKTH, or failing with SFBL at the band limit (stop mode) or start channel (wrap mode)
+ * - RDS groups of the tuned station are latched every group_interval_us, and RDSR stays set for
+ *   rdsr_hold_us or until the next group. Groups that are not read in time are lost.
+ * - in standard RDS mode, groups with uncorrectable blocks are dropped; verbose mode (RDSM)
+ *   delivers them with BLER set
+ *
+ * Time comes from time_us_64(), which is virtual on the host (see pico_host.h). SKSNR / SKCNT,
+ * softmute and the GPIO2 interrupt are not modeled.
+ *
+ * Usage:
+ *
+ *     fm_sim_init(&sim, stations, count(stations));
+ *     fm_init(&radio, NULL, RESET_PIN, SDIO_PIN, SCLK_PIN, false);
+ *     fm_set_transport(&radio, &fm_sim_transport, &sim);
+ *     fm_power_up(&radio, fm_config_europe());
+ */
+
+/**
+ * \brief Simulated station.
+ */
+typedef struct fm_sim_station_t
+{
+    uint16_t frequency; /**< In 10 kHz units. */
+    uint8_t rssi; /**< Received signal strength, in dBuV. */
+    bool stereo;
+    uint8_t block_error_percent; /**< Chance of each RDS block being uncorrectable. */
+    rds_replay_t *rds; /**< RDS groups, NULL if the station has no RDS. */
+} fm_sim_station_t;
+
+// private
+typedef enum fm_sim_operation_t
+{
+    FM_SIM_IDLE,
+    FM_SIM_TUNING,
+    FM_SIM_SEEKING,
+} fm_sim_operation_t;
+
+/**
+ * \brief Simulator state.
+ *
+ * Timing fields are set by fm_sim_init() and may be changed afterwards.
+ */
+typedef struct fm_sim_t
+{
+    const fm_sim_station_t *stations;
+    size_t station_count;
+    bool si4702; /**< Report a Si4702, without RDS. */
+    uint8_t noise_rssi; /**< RSSI of channels without a station. */
+    uint32_t tune_time_us; /**< Time to tune one channel, also per seek step. */
+    uint32_t group_interval_us; /**< Time between RDS groups, lower to replay faster. */
+    uint32_t rdsr_hold_us; /**< How long RDSR stays set after a group. */
+
+    uint32_t reads; /**< Number of register reads. */
+    uint32_t writes; /**< Number of register writes. */
+    uint32_t rds_groups; /**< RDS groups latched. */
+    uint32_t rds_groups_dropped; /**< RDS groups dropped in standard mode. */
+
+    // private
+    uint16_t regs[16];
+    fm_sim_operation_t operation;
+    uint64_t operation_start;
+    uint64_t operation_end;
+    uint16_t start_channel;
+    uint16_t end_channel;
+    bool seek_up;
+    bool seek_failed;
+    const fm_sim_station_t *station; // tuned, with RDS
+    uint64_t next_group_time;
+    uint64_t rdsr_time;
+    uint32_t random;
+} fm_sim_t;
+
+/**
+ * \brief Transport functions for fm_set_transport(), with a fm_sim_t context.
+ */
+extern const fm_transport_t fm_sim_transport;
+
+/**
+ * \brief Initialize the simulator.
+ *
+ * @param sim Simulator state.
+ * @param stations Stations, must outlive the simulator.
+ * @param station_count Number of stations.
+ */
+void fm_sim_init(fm_sim_t *sim, const fm_sim_station_t *stations, size_t station_count);
+
+/**
+ * \brief Get the tuned station.
+ *
+ * @param sim Simulator state.
+ * @return Station on the current channel, or NULL if none or still tuning.
+ */
+const fm_sim_station_t *fm_sim_get_station(fm_sim_t *sim);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _FM_SIM_H_
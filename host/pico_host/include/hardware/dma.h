@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HOST_DMA_H_
+#define _PICO_HOST_DMA_H_
+
+// No DMA channels on the host, so fm_enable_dma() fails and transfers stay blocking.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+typedef struct dma_channel_config
+{
+    uint32_t ctrl;
+} dma_channel_config;
+
+enum dma_channel_transfer_size
+{
+    DMA_SIZE_8 = 0,
+    DMA_SIZE_16 = 1,
+    DMA_SIZE_32 = 2,
+};
+
+static inline int dma_claim_unused_channel(bool required) { return (void)required, -1; }
+
+static inline void dma_channel_unclaim(uint channel) { (void)channel; }
+
+static inline dma_channel_config dma_channel_get_default_config(uint channel) { return (void)channel, (dma_channel_config){0}; }
+
+static inline void channel_config_set_transfer_data_size(dma_channel_config *c, enum dma_channel_transfer_size size) { (void)c, (void)size; }
+
+static inline void channel_config_set_read_increment(dma_channel_config *c, bool incr) { (void)c, (void)incr; }
+
+static inline void channel_config_set_write_increment(dma_channel_config *c, bool incr) { (void)c, (void)incr; }
+
+static inline void channel_config_set_dreq(dma_channel_config *c, uint dreq) { (void)c, (void)dreq; }
+
+static inline void dma_channel_configure(uint channel, const dma_channel_config *config, volatile void *write_addr,
+    const volatile void *read_addr, uint transfer_count, bool trigger) {
+    (void)channel, (void)config, (void)write_addr, (void)read_addr, (void)transfer_count, (void)trigger;
+}
+
+static inline bool dma_channel_is_busy(uint channel) { return (void)channel, false; }
+
+static inline void dma_channel_abort(uint channel) { (void)channel; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PICO_HOST_DMA_H_
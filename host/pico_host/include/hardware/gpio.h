@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HOST_GPIO_H_
+#define _PICO_HOST_GPIO_H_
+
+// GPIO calls are accepted and ignored. Interrupts never fire.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+typedef void (*irq_handler_t)(void);
+
+enum gpio_function
+{
+    GPIO_FUNC_I2C = 3,
+    GPIO_FUNC_SIO = 5,
+};
+
+#define GPIO_IN 0
+#define GPIO_OUT 1
+
+#define GPIO_IRQ_EDGE_FALL 0x4u
+
+#define NUM_BANK0_GPIOS 30
+
+#define IO_IRQ_BANK0 13
+
+static inline void gpio_init(uint gpio) { (void)gpio; }
+
+static inline void gpio_set_dir(uint gpio, bool out) { (void)gpio, (void)out; }
+
+static inline void gpio_put(uint gpio, bool value) { (void)gpio, (void)value; }
+
+static inline void gpio_set_function(uint gpio, enum gpio_function fn) { (void)gpio, (void)fn; }
+
+static inline void gpio_pull_up(uint gpio) { (void)gpio; }
+
+static inline void gpio_set_irq_enabled(uint gpio, uint32_t events, bool enabled) { (void)gpio, (void)events, (void)enabled; }
+
+static inline void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) { (void)gpio, (void)handler; }
+
+static inline uint32_t gpio_get_irq_event_mask(uint gpio) { return (void)gpio, 0; }
+
+static inline void gpio_acknowledge_irq(uint gpio, uint32_t events) { (void)gpio, (void)events; }
+
+static inline void irq_set_enabled(uint num, bool enabled) { (void)num, (void)enabled; }
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PICO_HOST_GPIO_H_
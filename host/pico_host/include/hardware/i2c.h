@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HOST_I2C_H_
+#define _PICO_HOST_I2C_H_
+
+// There is no hardware I2C on the host, blocking transfers fail. Pass a transport with
+// fm_set_transport() instead, e.g. the simulator in fm_sim.h.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef unsigned int uint;
+
+typedef struct i2c_hw_t
+{
+    volatile uint32_t enable;
+    volatile uint32_t tar;
+    volatile uint32_t data_cmd;
+    volatile uint32_t raw_intr_stat;
+    volatile uint32_t clr_tx_abrt;
+    volatile uint32_t clr_stop_det;
+} i2c_hw_t;
+
+typedef struct i2c_inst
+{
+    i2c_hw_t *hw;
+    bool restart_on_next;
+} i2c_inst_t;
+
+#define I2C_IC_DATA_CMD_CMD_BITS 0x100u
+#define I2C_IC_DATA_CMD_STOP_BITS 0x200u
+#define I2C_IC_RAW_INTR_STAT_TX_ABRT_BITS 0x40u
+#define I2C_IC_RAW_INTR_STAT_STOP_DET_BITS 0x200u
+
+static inline i2c_hw_t *i2c_get_hw(i2c_inst_t *i2c) { return i2c->hw; }
+
+static inline uint i2c_get_dreq(i2c_inst_t *i2c, bool is_tx) { return (void)i2c, is_tx; }
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop);
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PICO_HOST_I2C_H_
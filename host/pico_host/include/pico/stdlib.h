@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HOST_STDLIB_H_
+#define _PICO_HOST_STDLIB_H_
+
+// Host stand-in for the subset of the Pico SDK used by the libraries, see pico_host.h.
+
+#include <hardware/gpio.h>
+#include <pico_host.h>
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#define count_of(a) (sizeof(a) / sizeof((a)[0]))
+
+#define PICO_ERROR_GENERIC -1
+
+uint64_t time_us_64(void);
+
+uint32_t time_us_32(void);
+
+void sleep_us(uint64_t us);
+
+void sleep_ms(uint32_t ms);
+
+void busy_wait_us_32(uint32_t us);
+
+void tight_loop_contents(void);
+
+void panic(const char *fmt, ...);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PICO_HOST_STDLIB_H_
@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _PICO_HOST_H_
+#define _PICO_HOST_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file pico_host.h
+ *
+ * \brief Pico SDK stand-in for host builds.
+ *
+ * Time is virtual: time_us_64() starts at zero and only moves when the program sleeps or
+ * busy-waits, so a simulated tune or seek completes instantly in wall-clock time, and runs are
+ * reproducible. tight_loop_contents() advances the clock by one microsecond, so polling loops
+ * make progress.
+ */
+
+/**
+ * \brief Advance the virtual clock.
+ *
+ * @param us Microseconds.
+ */
+void pico_host_advance_us(uint64_t us);
+
+/**
+ * \brief Wall-clock time in nanoseconds, for measuring host CPU cost.
+ *
+ * @return Monotonic time.
+ */
+uint64_t pico_host_wall_time_ns(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _PICO_HOST_H_
@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <hardware/i2c.h>
+#include <pico/stdlib.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static uint64_t virtual_time_us;
+
+//
+// public interface
+//
+
+void pico_host_advance_us(uint64_t us) {
+    virtual_time_us += us;
+}
+
+uint64_t pico_host_wall_time_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+uint64_t time_us_64(void) {
+    return virtual_time_us;
+}
+
+uint32_t time_us_32(void) {
+    return (uint32_t)virtual_time_us;
+}
+
+void sleep_us(uint64_t us) {
+    pico_host_advance_us(us);
+}
+
+void sleep_ms(uint32_t ms) {
+    pico_host_advance_us(ms * 1000ull);
+}
+
+void busy_wait_us_32(uint32_t us) {
+    pico_host_advance_us(us);
+}
+
+void tight_loop_contents(void) {
+    pico_host_advance_us(1);
+}
+
+void panic(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    vfprintf(stderr, fmt, args);
+    va_end(args);
+    fputc('\n', stderr);
+    abort();
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t addr, uint8_t *dst, size_t len, bool nostop) {
+    (void)i2c, (void)addr, (void)dst, (void)len, (void)nostop;
+    return PICO_ERROR_GENERIC;
+}
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t addr, const uint8_t *src, size_t len, bool nostop) {
+    (void)i2c, (void)addr, (void)src, (void)len, (void)nostop;
+    return PICO_ERROR_GENERIC;
+}
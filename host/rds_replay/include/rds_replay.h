@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _RDS_REPLAY_H_
+#define _RDS_REPLAY_H_
+
+#include <rds_group_queue.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file rds_replay.h
+ *
+ * \brief Source of recorded or synthesized RDS groups, for host builds.
+ *
+ * Groups are loaded from binary streams recorded with rds_capture.h, or from text captures
+ * with one group per line:
+ *
+ *     # comment
+ *     E2B5 0408 E0CD 4142
+ *     E2B5 ---- 2020 2020
+ *
+ * Each of the first four fields is a block in hex, or "----" for an uncorrectable block.
+ * Anything after them is ignored, so RDS Spy logs with trailing timestamps load as well.
+ *
+ * Replay loops over the groups. Groups from binary streams keep their recorded timestamp,
+ * the others are timestamped as if received back to back at the RDS group rate.
+ */
+
+/** Time to transmit one group at 1187.5 bit/s. */
+#define RDS_REPLAY_GROUP_INTERVAL_US 87579
+
+/**
+ * \brief Station to synthesize groups for.
+ */
+typedef struct rds_replay_station_t
+{
+    uint16_t pi;
+    uint8_t pty;
+    bool tp;
+    const char *ps; /**< Up to 8 characters. */
+    const char *rt; /**< Up to 64 characters, may be NULL. */
+    const uint16_t *alt_freqs; /**< AF method A list in 10 kHz units, may be NULL. */
+    size_t alt_freq_count; /**< Up to 25. */
+} rds_replay_station_t;
+
+/**
+ * \brief Group sequence.
+ */
+typedef struct rds_replay_t
+{
+    rds_group_entry_t *entries;
+    size_t count;
+    size_t capacity;
+    size_t position; // next entry to replay
+    uint32_t loops; // completed passes over all entries
+} rds_replay_t;
+
+/**
+ * \brief Initialize an empty sequence.
+ *
+ * @param replay Group sequence.
+ */
+void rds_replay_init(rds_replay_t *replay);
+
+/**
+ * \brief Release memory.
+ *
+ * @param replay Group sequence.
+ */
+void rds_replay_free(rds_replay_t *replay);
+
+/**
+ * \brief Append a group.
+ *
+ * @param replay Group sequence.
+ * @param group RDS group.
+ * @param bler Error level for blocks A-D, may be NULL if error free.
+ */
+void rds_replay_add(rds_replay_t *replay, const rds_group_t *group, const uint8_t *bler);
+
+/**
+ * \brief Append groups from a capture file.
+ *
+ * The file is read as a binary rds_capture stream if it contains any valid frame, otherwise
+ * as text.
+ *
+ * @param replay Group sequence.
+ * @param path Capture file.
+ * @return Number of groups loaded, or -1 if the file couldn't be read.
+ */
+int rds_replay_load(rds_replay_t *replay, const char *path);
+
+/**
+ * \brief Append one broadcast cycle of a station.
+ *
+ * Interleaves 0A groups (PS, flags, AF) with 2A groups (radio text), so the whole PS is sent
+ * several times and the radio text once.
+ *
+ * @param replay Group sequence.
+ * @param station Station data.
+ */
+void rds_replay_synthesize(rds_replay_t *replay, const rds_replay_station_t *station);
+
+/**
+ * \brief Get the next group, looping back to the first one at the end.
+ *
+ * @param replay Group sequence, must not be empty.
+ * @return Group entry, valid until the sequence is modified.
+ */
+const rds_group_entry_t *rds_replay_next(rds_replay_t *replay);
+
+/**
+ * \brief Restart from the first group.
+ *
+ * @param replay Group sequence.
+ */
+static inline void rds_replay_rewind(rds_replay_t *replay) {
+    replay->position = 0;
+    replay->loops = 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RDS_REPLAY_H_
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <rds_capture.h>
+#include <rds_replay.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define RDS_REPLAY_MAX_ALT_FREQS 25
+
+#define MIN(a, b) ((b) > (a) ? (a) : (b))
+
+//
+// capture parsing
+//
+
+static bool rds_replay_parse_block(const char *token, uint16_t *block, uint8_t *bler) {
+    if (strcmp(token, "----") == 0) {
+        *block = 0;
+        *bler = 3;
+        return true;
+    }
+    if (strlen(token) != 4) {
+        return false;
+    }
+    for (size_t i = 0; i < 4; i++) {
+        if (!isxdigit((unsigned char)token[i])) {
+            return false;
+        }
+    }
+    *block = (uint16_t)strtoul(token, NULL, 16);
+    *bler = 0;
+    return true;
+}
+
+static bool rds_replay_parse_line(const char *line, rds_group_t *group, uint8_t *bler) {
+    char tokens[4][8];
+    if (sscanf(line, "%7s %7s %7s %7s", tokens[0], tokens[1], tokens[2], tokens[3]) != 4 || tokens[0][0] == '#') {
+        return false; // blank, comment or truncated
+    }
+    for (size_t i = 0; i < 4; i++) {
+        if (!rds_replay_parse_block(tokens[i], &group->blocks[i], &bler[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int rds_replay_parse_text(rds_replay_t *replay, const char *data, size_t len) {
+    int loaded = 0;
+    const char *line = data;
+    const char *end = data + len;
+    while (line < end) {
+        const char *next = memchr(line, '\n', end - line);
+        if (next == NULL) {
+            next = end;
+        }
+        char buf[256];
+        size_t line_len = MIN((size_t)(next - line), sizeof(buf) - 1);
+        memcpy(buf, line, line_len);
+        buf[line_len] = '\0';
+
+        rds_group_t group;
+        uint8_t bler[4];
+        if (rds_replay_parse_line(buf, &group, bler)) {
+            rds_replay_add(replay, &group, bler);
+            loaded++;
+        }
+        line = next + 1;
+    }
+    return loaded;
+}
+
+static int rds_replay_parse_capture(rds_replay_t *replay, const uint8_t *data, size_t len) {
+    // binary stream from rds_capture, skipping anything that isn't a valid frame
+    int loaded = 0;
+    size_t i = 0;
+    while (i + RDS_CAPTURE_FRAME_SIZE <= len) {
+        rds_capture_record_t record;
+        if (!rds_capture_decode(data + i, &record)) {
+            i++;
+            continue;
+        }
+        rds_replay_add(replay, &record.entry.group, record.entry.bler);
+        replay->entries[replay->count - 1].timestamp_us = record.entry.timestamp_us;
+        loaded++;
+        i += RDS_CAPTURE_FRAME_SIZE;
+    }
+    return loaded;
+}
+
+//
+// synthesis
+//
+
+static uint8_t rds_replay_encode_alt_freq(uint16_t frequency) {
+    // 87.6 MHz -> 1, ..., 107.9 MHz -> 204
+    if (frequency < 8760 || 10790 < frequency) {
+        return 205; // filler
+    }
+    return (uint8_t)((frequency - 8750) / 10);
+}
+
+static void rds_replay_pad(char *dst, const char *src, size_t size, char pad) {
+    size_t len = (src == NULL) ? 0 : strlen(src);
+    if (size < len) {
+        len = size;
+    }
+    if (len != 0) {
+        memcpy(dst, src, len);
+    }
+    memset(dst + len, pad, size - len);
+}
+
+static void rds_replay_add_ps_group(rds_replay_t *replay, const rds_replay_station_t *station, const char *ps,
+    const uint8_t *af_codes, size_t af_code_count, size_t ps_segment, size_t af_pair) {
+    // block C carries two AF codes, the first pair starts with the list length
+    uint8_t af[2];
+    size_t i = 2 * af_pair;
+    af[0] = (af_pair == 0) ? 224 + (uint8_t)af_code_count : af_codes[i - 1];
+    af[1] = (i < af_code_count) ? af_codes[i] : 205 /* filler */;
+    bool di = (ps_segment == 3); // stereo
+    rds_group_t group = {
+        .a = station->pi,
+        .b = (uint16_t)((station->tp << 10) | ((station->pty & 0x1F) << 5) | (1 << 3) /* music */ | (di << 2) | ps_segment),
+        .c = (uint16_t)((af[0] << 8) | af[1]),
+        .d = (uint16_t)(((uint8_t)ps[2 * ps_segment] << 8) | (uint8_t)ps[2 * ps_segment + 1]),
+    };
+    rds_replay_add(replay, &group, NULL);
+}
+
+static void rds_replay_add_rt_group(rds_replay_t *replay, const rds_replay_station_t *station, const char *rt, size_t rt_segment) {
+    const char *p = rt + 4 * rt_segment;
+    rds_group_t group = {
+        .a = station->pi,
+        .b = (uint16_t)((2 << 12) | (station->tp << 10) | ((station->pty & 0x1F) << 5) | rt_segment),
+        .c = (uint16_t)(((uint8_t)p[0] << 8) | (uint8_t)p[1]),
+        .d = (uint16_t)(((uint8_t)p[2] << 8) | (uint8_t)p[3]),
+    };
+    rds_replay_add(replay, &group, NULL);
+}
+
+//
+// public interface
+//
+
+void rds_replay_init(rds_replay_t *replay) {
+    memset(replay, 0, sizeof(rds_replay_t));
+}
+
+void rds_replay_free(rds_replay_t *replay) {
+    free(replay->entries);
+    rds_replay_init(replay);
+}
+
+void rds_replay_add(rds_replay_t *replay, const rds_group_t *group, const uint8_t *bler) {
+    if (replay->count == replay->capacity) {
+        size_t capacity = (replay->capacity == 0) ? 64 : 2 * replay->capacity;
+        rds_group_entry_t *entries = realloc(replay->entries, capacity * sizeof(rds_group_entry_t));
+        if (entries == NULL) {
+            abort();
+        }
+        replay->entries = entries;
+        replay->capacity = capacity;
+    }
+    rds_group_entry_t *entry = &replay->entries[replay->count];
+    entry->group = *group;
+    if (bler != NULL) {
+        memcpy(entry->bler, bler, sizeof(entry->bler));
+    } else {
+        memset(entry->bler, 0, sizeof(entry->bler));
+    }
+    entry->timestamp_us = (uint32_t)(replay->count * RDS_REPLAY_GROUP_INTERVAL_US);
+    replay->count++;
+}
+
+int rds_replay_load(rds_replay_t *replay, const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL) {
+        return -1;
+    }
+    uint8_t *data = NULL;
+    size_t len = 0;
+    size_t capacity = 0;
+    size_t n;
+    do {
+        if (len == capacity) {
+            capacity = (capacity == 0) ? 4096 : 2 * capacity;
+            data = realloc(data, capacity);
+            if (data == NULL) {
+                abort();
+            }
+        }
+        n = fread(data + len, 1, capacity - len, file);
+        len += n;
+    } while (n != 0);
+    fclose(file);
+
+    int loaded = rds_replay_parse_capture(replay, data, len);
+    if (loaded == 0) {
+        loaded = rds_replay_parse_text(replay, (const char *)data, len);
+    }
+    free(data);
+    return loaded;
+}
+
+void rds_replay_synthesize(rds_replay_t *replay, const rds_replay_station_t *station) {
+    assert(station->alt_freq_count <= RDS_REPLAY_MAX_ALT_FREQS);
+
+    char ps[8];
+    rds_replay_pad(ps, station->ps, sizeof(ps), ' ');
+
+    char rt[64];
+    size_t rt_segments = 0;
+    if (station->rt != NULL) {
+        size_t len = strlen(station->rt);
+        rds_replay_pad(rt, station->rt, sizeof(rt), ' ');
+        if (len < sizeof(rt)) {
+            rt[len++] = '\r'; // end marker
+        }
+        rt_segments = (len + 3) / 4;
+    }
+
+    uint8_t af_codes[RDS_REPLAY_MAX_ALT_FREQS];
+    for (size_t i = 0; i < station->alt_freq_count; i++) {
+        af_codes[i] = rds_replay_encode_alt_freq(station->alt_freqs[i]);
+    }
+    size_t af_pairs = station->alt_freq_count / 2 + 1; // up to 13, all sent within the PS groups
+
+    // 4 PS passes, with up to 16 radio text segments in between
+    for (size_t i = 0; i < 16; i++) {
+        rds_replay_add_ps_group(replay, station, ps, af_codes, station->alt_freq_count, i % 4, i % af_pairs);
+        if (i < rt_segments) {
+            rds_replay_add_rt_group(replay, station, rt, i);
+        }
+    }
+}
+
+const rds_group_entry_t *rds_replay_next(rds_replay_t *replay) {
+    assert(replay->count != 0);
+
+    const rds_group_entry_t *entry = &replay->entries[replay->position];
+    if (++replay->position == replay->count) {
+        replay->position = 0;
+        replay->loops++;
+    }
+    return entry;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _RDS_CAPTURE_H_
+#define _RDS_CAPTURE_H_
+
+#include <rds_group_queue.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file rds_capture.h
+ *
+ * \brief Binary stream of raw RDS groups, for offline analysis.
+ *
+ * Each group is sent as a fixed-size frame, all fields little-endian:
+ *
+ *     offset  size  field
+ *          0     2  sync, A5 5A
+ *          2     1  sequence number, gaps mean dropped frames
+ *          3     4  timestamp_us
+ *          7     8  blocks A-D
+ *         15     1  BLER, 2 bits per block, A in the lowest bits
+ *         16     1  RSSI
+ *         17     2  frequency, in 10 kHz units
+ *         19     1  CRC-8 (polynomial 0x07) of bytes 2-18
+ *
+ * Frames are found by sync and CRC, so a reader resynchronizes after lost bytes or text
+ * printed on the same channel. The replay harness loads these streams directly.
+ *
+ * Frames are collected in one buffer while the other is being sent. rds_capture_add() only
+ * copies bytes, and rds_capture_drain() writes as much as the output accepts without waiting,
+ * so a slow or disconnected reader never stalls RDS reception. When both buffers are full,
+ * new frames are dropped.
+ *
+ * Usage:
+ *
+ *     rds_capture_init(&capture);
+ *     ...
+ *     rds_capture_add(&capture, &entry, fm_get_frequency_10khz(&radio), rssi);
+ *     rds_capture_drain(&capture, write_usb, NULL);
+ */
+
+#ifndef RDS_CAPTURE_BUFFER_SIZE
+#define RDS_CAPTURE_BUFFER_SIZE 240
+#endif
+
+#define RDS_CAPTURE_FRAME_SIZE 20
+
+static_assert(RDS_CAPTURE_FRAME_SIZE <= RDS_CAPTURE_BUFFER_SIZE, "buffer must hold a frame");
+
+/**
+ * \brief Decoded capture frame.
+ */
+typedef struct rds_capture_record_t
+{
+    rds_group_entry_t entry; /**< Group, error levels and timestamp. */
+    uint16_t frequency; /**< In 10 kHz units. */
+    uint8_t rssi;
+    uint8_t sequence;
+} rds_capture_record_t;
+
+/**
+ * \brief Write callback for rds_capture_drain().
+ *
+ * Must not block.
+ *
+ * @param context User data.
+ * @param data Bytes to send.
+ * @param len Number of bytes.
+ * @return Number of bytes accepted, from 0 to len.
+ */
+typedef size_t (*rds_capture_write_t)(void *context, const uint8_t *data, size_t len);
+
+/**
+ * \brief Double-buffered capture stream.
+ */
+typedef struct rds_capture_t
+{
+    uint8_t buffers[2][RDS_CAPTURE_BUFFER_SIZE];
+    uint16_t lengths[2];
+    uint8_t filling; // buffer collecting frames, the other one is being sent
+    uint16_t sent; // bytes of the other buffer already written
+    uint8_t sequence;
+    uint32_t dropped; /**< Frames lost because both buffers were full. */
+} rds_capture_t;
+
+/**
+ * \brief Clear the stream.
+ *
+ * @param capture Capture stream.
+ */
+void rds_capture_init(rds_capture_t *capture);
+
+/**
+ * \brief Queue a group for sending.
+ *
+ * Not safe to call concurrently with rds_capture_drain().
+ *
+ * @param capture Capture stream.
+ * @param entry Group, error levels and timestamp.
+ * @param frequency Tuned frequency in 10 kHz units.
+ * @param rssi Received signal strength.
+ * @return true Frame queued.
+ * @return false Both buffers full, frame dropped.
+ */
+bool rds_capture_add(rds_capture_t *capture, const rds_group_entry_t *entry, uint16_t frequency, uint8_t rssi);
+
+/**
+ * \brief Send pending frames, without blocking.
+ *
+ * Call regularly, e.g. from the main loop. Once the buffer being sent is done, the
+ * collecting buffer is handed over, even if only partly filled.
+ *
+ * @param capture Capture stream.
+ * @param write Output function.
+ * @param context User data passed to write.
+ * @return Number of bytes written.
+ */
+size_t rds_capture_drain(rds_capture_t *capture, rds_capture_write_t write, void *context);
+
+/**
+ * \brief Check if frames are waiting to be sent.
+ *
+ * @param capture Capture stream.
+ * @return true Pending frames.
+ */
+static inline bool rds_capture_is_pending(const rds_capture_t *capture) {
+    return capture->lengths[0] != 0 || capture->lengths[1] != 0;
+}
+
+/**
+ * \brief Encode a frame.
+ *
+ * @param record Frame contents.
+ * @param frame Output, RDS_CAPTURE_FRAME_SIZE bytes.
+ */
+void rds_capture_encode(const rds_capture_record_t *record, uint8_t *frame);
+
+/**
+ * \brief Decode a frame.
+ *
+ * @param frame Input, RDS_CAPTURE_FRAME_SIZE bytes.
+ * @param record Output frame contents.
+ * @return true Valid frame.
+ * @return false Sync or CRC mismatch.
+ */
+bool rds_capture_decode(const uint8_t *frame, rds_capture_record_t *record);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RDS_CAPTURE_H_
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <rds_capture.h>
+#include <string.h>
+
+#define SYNC_0 0xA5
+#define SYNC_1 0x5A
+
+//
+// framing
+//
+
+static uint8_t rds_capture_crc8(const uint8_t *data, size_t len) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+static void rds_capture_put_u16(uint8_t *p, uint16_t value) {
+    p[0] = value & 0xFF;
+    p[1] = value >> 8;
+}
+
+static uint16_t rds_capture_get_u16(const uint8_t *p) {
+    return p[0] | (p[1] << 8);
+}
+
+//
+// public interface
+//
+
+void rds_capture_init(rds_capture_t *capture) {
+    capture->lengths[0] = 0;
+    capture->lengths[1] = 0;
+    capture->filling = 0;
+    capture->sent = 0;
+    capture->sequence = 0;
+    capture->dropped = 0;
+}
+
+bool rds_capture_add(rds_capture_t *capture, const rds_group_entry_t *entry, uint16_t frequency, uint8_t rssi) {
+    uint8_t filling = capture->filling;
+    if (RDS_CAPTURE_BUFFER_SIZE < capture->lengths[filling] + RDS_CAPTURE_FRAME_SIZE) {
+        if (capture->lengths[filling ^ 1] != 0) {
+            capture->dropped++;
+            capture->sequence++; // leave a gap
+            return false;
+        }
+        filling ^= 1; // the other buffer has been sent
+        capture->filling = filling;
+        capture->sent = 0;
+    }
+    rds_capture_record_t record = {
+        .entry = *entry,
+        .frequency = frequency,
+        .rssi = rssi,
+        .sequence = capture->sequence++,
+    };
+    rds_capture_encode(&record, capture->buffers[filling] + capture->lengths[filling]);
+    capture->lengths[filling] += RDS_CAPTURE_FRAME_SIZE;
+    return true;
+}
+
+size_t rds_capture_drain(rds_capture_t *capture, rds_capture_write_t write, void *context) {
+    uint8_t sending = capture->filling ^ 1;
+    if (capture->lengths[sending] == 0) {
+        if (capture->lengths[capture->filling] == 0) {
+            return 0; // idle
+        }
+        // hand over the partly filled buffer, so frames don't wait for it to fill up
+        sending = capture->filling;
+        capture->filling ^= 1;
+        capture->sent = 0;
+    }
+    size_t remaining = capture->lengths[sending] - capture->sent;
+    size_t written = write(context, capture->buffers[sending] + capture->sent, remaining);
+    if (written < remaining) {
+        capture->sent += written;
+    } else {
+        capture->lengths[sending] = 0;
+        capture->sent = 0;
+    }
+    return written;
+}
+
+void rds_capture_encode(const rds_capture_record_t *record, uint8_t *frame) {
+    const rds_group_entry_t *entry = &record->entry;
+    frame[0] = SYNC_0;
+    frame[1] = SYNC_1;
+    frame[2] = record->sequence;
+    rds_capture_put_u16(frame + 3, entry->timestamp_us & 0xFFFF);
+    rds_capture_put_u16(frame + 5, entry->timestamp_us >> 16);
+    rds_capture_put_u16(frame + 7, entry->group.a);
+    rds_capture_put_u16(frame + 9, entry->group.b);
+    rds_capture_put_u16(frame + 11, entry->group.c);
+    rds_capture_put_u16(frame + 13, entry->group.d);
+    frame[15] = (entry->bler[0] & 3) | (entry->bler[1] & 3) << 2 | (entry->bler[2] & 3) << 4 | (entry->bler[3] & 3) << 6;
+    frame[16] = record->rssi;
+    rds_capture_put_u16(frame + 17, record->frequency);
+    frame[19] = rds_capture_crc8(frame + 2, RDS_CAPTURE_FRAME_SIZE - 3);
+}
+
+bool rds_capture_decode(const uint8_t *frame, rds_capture_record_t *record) {
+    if (frame[0] != SYNC_0 || frame[1] != SYNC_1 || frame[19] != rds_capture_crc8(frame + 2, RDS_CAPTURE_FRAME_SIZE - 3)) {
+        return false;
+    }
+    rds_group_entry_t *entry = &record->entry;
+    record->sequence = frame[2];
+    entry->timestamp_us = rds_capture_get_u16(frame + 3) | (uint32_t)rds_capture_get_u16(frame + 5) << 16;
+    entry->group.a = rds_capture_get_u16(frame + 7);
+    entry->group.b = rds_capture_get_u16(frame + 9);
+    entry->group.c = rds_capture_get_u16(frame + 11);
+    entry->group.d = rds_capture_get_u16(frame + 13);
+    for (size_t i = 0; i < 4; i++) {
+        entry->bler[i] = (frame[15] >> (2 * i)) & 3;
+    }
+    record->rssi = frame[16];
+    record->frequency = rds_capture_get_u16(frame + 17);
+    return true;
+}
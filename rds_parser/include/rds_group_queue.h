@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2021 Valentin Milea <valentin.milea@gmail.com>
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef _RDS_GROUP_QUEUE_H_
+#define _RDS_GROUP_QUEUE_H_
+
+#include <rds_parser.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** \file rds_group_queue.h
+ *
+ * \brief Lock-free queue of RDS groups.
+ *
+ * Decouples RDS capture from parsing. A single producer (e.g. a GPIO IRQ or core1) pushes
+ * groups as they are read from the radio chip, and a single consumer drains them in batches
+ * at its own pace.
+ *
+ * Push and pop may run concurrently on different cores, or in IRQ and thread context. Using
+ * more than one producer or more than one consumer requires external locking.
+ */
+
+#ifndef RDS_GROUP_QUEUE_CAPACITY
+#define RDS_GROUP_QUEUE_CAPACITY 16
+#endif
+
+static_assert((RDS_GROUP_QUEUE_CAPACITY & (RDS_GROUP_QUEUE_CAPACITY - 1)) == 0, "capacity must be a power of 2");
+
+/**
+ * \brief RDS group with reception details.
+ */
+typedef struct rds_group_entry_t
+{
+    rds_group_t group;
+    uint8_t bler[4]; /**< Error level for blocks A-D, from 0 (no errors) to 3 (uncorrectable). */
+    uint32_t timestamp_us; /**< Reception time. Wraps around every ~71 minutes. */
+} rds_group_entry_t;
+
+/**
+ * \brief Single-producer / single-consumer RDS group queue.
+ */
+typedef struct rds_group_queue_t
+{
+    rds_group_entry_t entries[RDS_GROUP_QUEUE_CAPACITY];
+    uint32_t head; // next slot to write, owned by producer
+    uint32_t tail; // next slot to read, owned by consumer
+    uint32_t dropped; // groups lost because the queue was full, owned by producer
+} rds_group_queue_t;
+
+/**
+ * \brief Clear the queue.
+ *
+ * Must not be called while the producer or consumer are active.
+ *
+ * @param queue RDS group queue.
+ */
+static inline void rds_group_queue_init(rds_group_queue_t *queue) {
+    queue->head = 0;
+    queue->tail = 0;
+    queue->dropped = 0;
+}
+
+/**
+ * \brief Get the number of queued groups.
+ *
+ * @param queue RDS group queue.
+ */
+static inline size_t rds_group_queue_get_count(const rds_group_queue_t *queue) {
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    return head - tail;
+}
+
+/**
+ * \brief Get the number of groups dropped because the queue was full.
+ *
+ * @param queue RDS group queue.
+ */
+static inline uint32_t rds_group_queue_get_dropped(const rds_group_queue_t *queue) {
+    return __atomic_load_n(&queue->dropped, __ATOMIC_RELAXED);
+}
+
+/**
+ * \brief Reserve the next slot for writing.
+ *
+ * Producer only. The slot is published by rds_group_queue_commit_push(). This allows filling
+ * the entry in place, without an intermediate copy.
+ *
+ * @param queue RDS group queue.
+ * @return Slot to fill, or NULL if the queue is full. In that case the group is counted as dropped.
+ */
+static inline rds_group_entry_t *rds_group_queue_begin_push(rds_group_queue_t *queue) {
+    uint32_t head = queue->head;
+    uint32_t tail = __atomic_load_n(&queue->tail, __ATOMIC_ACQUIRE);
+    if (head - tail == RDS_GROUP_QUEUE_CAPACITY) {
+        __atomic_store_n(&queue->dropped, queue->dropped + 1, __ATOMIC_RELAXED);
+        return NULL; // full
+    }
+    return &queue->entries[head & (RDS_GROUP_QUEUE_CAPACITY - 1)];
+}
+
+/**
+ * \brief Publish the slot obtained from rds_group_queue_begin_push().
+ *
+ * Producer only.
+ *
+ * @param queue RDS group queue.
+ */
+static inline void rds_group_queue_commit_push(rds_group_queue_t *queue) {
+    __atomic_store_n(&queue->head, queue->head + 1, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Add a group to the queue.
+ *
+ * Producer only.
+ *
+ * @param queue RDS group queue.
+ * @param entry Group to copy.
+ * @return true The group was queued.
+ * @return false The queue is full, group dropped.
+ */
+static inline bool rds_group_queue_push(rds_group_queue_t *queue, const rds_group_entry_t *entry) {
+    rds_group_entry_t *slot = rds_group_queue_begin_push(queue);
+    if (slot == NULL) {
+        return false;
+    }
+    *slot = *entry;
+    rds_group_queue_commit_push(queue);
+    return true;
+}
+
+/**
+ * \brief Remove up to max_count groups from the queue.
+ *
+ * Consumer only.
+ *
+ * @param queue RDS group queue.
+ * @param entries Output buffer.
+ * @param max_count Capacity of the output buffer.
+ * @return Number of groups removed.
+ */
+static inline size_t rds_group_queue_pop_batch(rds_group_queue_t *queue, rds_group_entry_t *entries, size_t max_count) {
+    uint32_t tail = queue->tail;
+    uint32_t head = __atomic_load_n(&queue->head, __ATOMIC_ACQUIRE);
+    size_t count = head - tail;
+    if (max_count < count) {
+        count = max_count;
+    }
+    for (size_t i = 0; i < count; i++) {
+        entries[i] = queue->entries[(tail + i) & (RDS_GROUP_QUEUE_CAPACITY - 1)];
+    }
+    __atomic_store_n(&queue->tail, tail + count, __ATOMIC_RELEASE);
+    return count;
+}
+
+/**
+ * \brief Remove the oldest group from the queue.
+ *
+ * Consumer only.
+ *
+ * @param queue RDS group queue.
+ * @param entry Output entry.
+ * @return true A group was removed.
+ * @return false The queue is empty.
+ */
+static inline bool rds_group_queue_pop(rds_group_queue_t *queue, rds_group_entry_t *entry) {
+    return rds_group_queue_pop_batch(queue, entry, 1) == 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _RDS_GROUP_QUEUE_H_
@@ -32,17 +32,187 @@ extern "C" {
 #define RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE 1
 #endif
 
+#ifndef RDS_PARSER_CLOCK_TIME_ENABLE
+#define RDS_PARSER_CLOCK_TIME_ENABLE 0
+#endif
+
+#ifndef RDS_PARSER_PTYN_ENABLE
+#define RDS_PARSER_PTYN_ENABLE 0
+#endif
+
+#ifndef RDS_PARSER_EON_ENABLE
+#define RDS_PARSER_EON_ENABLE 0
+#endif
+
+#ifndef RDS_PARSER_EON_COUNT
+#define RDS_PARSER_EON_COUNT 4
+#endif
+
+#ifndef RDS_PARSER_ODA_ENABLE
+#define RDS_PARSER_ODA_ENABLE 0
+#endif
+
+#ifndef RDS_PARSER_ODA_COUNT
+#define RDS_PARSER_ODA_COUNT 4
+#endif
+
+#ifndef RDS_PARSER_TMC_ENABLE
+#define RDS_PARSER_TMC_ENABLE 0
+#endif
+
+#ifndef RDS_PARSER_STATS_ENABLE
+#define RDS_PARSER_STATS_ENABLE 0
+#endif
+
+/**
+ * \brief Matching receptions of each PS segment needed before the name is published.
+ *
+ * A single miscorrected block would otherwise show up in the name until the segment is
+ * sent again. Set to 1 to publish as soon as all four segments have been received.
+ */
+#ifndef RDS_PARSER_PS_MIN_HITS
+#define RDS_PARSER_PS_MIN_HITS 2
+#endif
+
+/**
+ * \brief Highest block error level accepted by rds_parser_update_with_errors().
+ *
+ * Levels are 0 (no errors), 1 (1-2 corrected errors), 2 (3-5 corrected errors) and
+ * 3 (uncorrectable). Heavily corrected blocks are often miscorrected, so by default only
+ * levels 0-1 are trusted.
+ */
+#ifndef RDS_PARSER_MAX_BLOCK_ERRORS
+#define RDS_PARSER_MAX_BLOCK_ERRORS 1
+#endif
+
+/**
+ * \brief Field change flags, returned by rds_parser_update() as a bitmask.
+ *
+ * Texts and lists are only reported once complete, and only if they differ from the
+ * previous value, so a display can redraw just what was flagged.
+ */
+typedef enum rds_change_t
+{
+    RDS_CHANGE_PI = 1 << 0, /**< Program identification. */
+    RDS_CHANGE_PTY = 1 << 1, /**< Program type. */
+    RDS_CHANGE_TP = 1 << 2, /**< Traffic program flag. */
+    RDS_CHANGE_TA = 1 << 3, /**< Traffic announcement flag. */
+    RDS_CHANGE_MS = 1 << 4, /**< Music / speech flag. */
+    RDS_CHANGE_DI = 1 << 5, /**< Decoder identification, committed. */
+    RDS_CHANGE_PS = 1 << 6, /**< Program service name, committed. */
+    RDS_CHANGE_RT = 1 << 7, /**< Radio text or its A/B flag, committed. */
+    RDS_CHANGE_AF = 1 << 8, /**< Alternative frequency added or marked regional. */
+    RDS_CHANGE_CLOCK_TIME = 1 << 9, /**< Clock time received. */
+    RDS_CHANGE_PTYN = 1 << 10, /**< Program type name, committed. */
+    RDS_CHANGE_EON = 1 << 11, /**< Other network added or updated. */
+    RDS_CHANGE_ODA = 1 << 12, /**< Open data application registered or updated. */
+    RDS_CHANGE_TMC = 1 << 13, /**< Traffic message group received. */
+    RDS_CHANGE_RT_PARTIAL = 1 << 14, /**< Radio text segment received, see rds_get_radio_text_partial(). */
+    RDS_CHANGE_RT_PLUS = 1 << 15, /**< Radio text plus tags changed. */
+} rds_change_t;
+
 /**
  * \brief RDS block group.
  */
 typedef struct rds_group_t
 {
-    uint16_t a;
-    uint16_t b;
-    uint16_t c;
-    uint16_t d;
+    union
+    {
+        struct
+        {
+            uint16_t a;
+            uint16_t b;
+            uint16_t c;
+            uint16_t d;
+        };
+        uint16_t blocks[4]; /**< Blocks A-D, for reading a group in place. */
+    };
 } rds_group_t;
 
+#if RDS_PARSER_CLOCK_TIME_ENABLE
+/**
+ * \brief Clock time and date from group 4A.
+ */
+typedef struct rds_clock_time_t
+{
+    uint32_t mjd; /**< Modified Julian Day, see rds_decode_date(). */
+    uint8_t hour; /**< UTC hour. */
+    uint8_t minute; /**< UTC minute. */
+    int8_t utc_offset; /**< Local time offset from UTC, in half hours. */
+} rds_clock_time_t;
+#endif
+
+#if RDS_PARSER_EON_ENABLE
+/**
+ * \brief Other network, from groups 14A / 14B.
+ */
+typedef struct rds_eon_t
+{
+    uint16_t pi; /**< PI code of the other network. */
+    char ps_str[9]; /**< Program service name, filled in as segments arrive. */
+    bool tp; /**< Traffic program flag of the other network. */
+    bool ta; /**< Traffic announcement flag of the other network, from 14B. */
+} rds_eon_t;
+#endif
+
+#if RDS_PARSER_ODA_ENABLE
+/**
+ * \brief Open data application, registered through group 3A.
+ */
+typedef struct rds_oda_t
+{
+    uint16_t aid; /**< Application identification, e.g. 0x4BD7 for RT+, 0xCD46 for TMC. */
+    uint8_t group_id; /**< Group carrying the application, as (type << 1) | version. */
+    uint16_t message; /**< Application data from block C. */
+} rds_oda_t;
+
+/**
+ * \brief Radio text plus tag, marking an item such as the title within the radio text.
+ */
+typedef struct rds_rt_plus_tag_t
+{
+    uint8_t content_type; /**< Content type, e.g. 1 for title, 4 for artist. 0 if unused. */
+    uint8_t start; /**< Offset of the first character in the radio text. */
+    uint8_t length; /**< Number of characters. */
+} rds_rt_plus_tag_t;
+
+/**
+ * \brief Radio text plus (RT+) state, decoded from the group registered for AID 0x4BD7.
+ */
+typedef struct rds_rt_plus_t
+{
+    rds_rt_plus_tag_t tags[2]; /**< Tags from the last RT+ group. */
+    bool item_toggle; /**< Flips when a new item starts. */
+    bool item_running; /**< An item, e.g. a song, is currently playing. */
+} rds_rt_plus_t;
+#endif
+
+#if RDS_PARSER_TMC_ENABLE
+/**
+ * \brief Last traffic message channel group 8A, undecoded.
+ */
+typedef struct rds_tmc_t
+{
+    uint8_t x; /**< Low 5 bits of block B. */
+    uint16_t y; /**< Block C. */
+    uint16_t z; /**< Block D. */
+    uint32_t count; /**< Groups received, incremented with each update. */
+} rds_tmc_t;
+#endif
+
+#if RDS_PARSER_STATS_ENABLE
+/**
+ * \brief Diagnostic counters. Not cleared by rds_parser_reset().
+ */
+typedef struct rds_parser_stats_t
+{
+    uint32_t groups; /**< Groups passed to the parser. */
+    uint32_t groups_rejected; /**< Groups dropped because block B was corrupted. */
+    uint32_t blocks_rejected; /**< Corrupted blocks, including those of rejected groups. */
+    uint32_t group_types[16]; /**< Accepted groups by type 0-15, versions A and B combined. */
+} rds_parser_stats_t;
+#endif
+
 /**
  * \brief RDS parser.
  */
@@ -57,15 +227,48 @@ typedef struct rds_parser_t
     uint8_t di_scratch; // back-buffer for decoder identification
     char ps_str[9]; // program service name
     char ps_scratch_str[9]; // back-buffer for program service name
+    uint8_t ps_segment_hits[4]; // matching receptions of each back-buffer segment
 #if RDS_PARSER_RADIO_TEXT_ENABLE
     char rt_str[65]; // radio text
     char rt_scratch_str[65]; // back-buffer for radio text
     bool rt_a_b; // alternating radio text flag
     bool rt_scratch_a_b; // back-bufer for alternating radio text flag
+    bool rt_scratch_2b; // back-buffer filled from 2B groups, 2 chars per segment
+    uint16_t rt_scratch_segments; // received back-buffer segments
+    uint8_t rt_scratch_end; // number of segments up to the terminator, 0 if not yet seen
 #endif
 #if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
-    uint8_t alt_freq[25];
+    uint32_t alt_freq_bitmap[7]; // one bit per raw frequency value 1-204
+    uint32_t alt_freq_regional_bitmap[7]; // method B, regional variants
     uint8_t alt_freq_count;
+    uint8_t alt_freq_tuned; // raw value of tuned frequency, 0 if unknown
+    bool alt_freq_method_b; // current list pairs each AF with the tuned frequency
+#endif
+#if RDS_PARSER_CLOCK_TIME_ENABLE
+    rds_clock_time_t clock_time;
+    bool has_clock_time;
+#endif
+#if RDS_PARSER_PTYN_ENABLE
+    char ptyn_str[9]; // program type name
+    char ptyn_scratch_str[9]; // back-buffer for program type name
+    bool ptyn_a_b;
+    uint8_t ptyn_scratch_segments; // received back-buffer segments
+#endif
+#if RDS_PARSER_EON_ENABLE
+    rds_eon_t eon[RDS_PARSER_EON_COUNT];
+    uint8_t eon_count;
+#endif
+#if RDS_PARSER_ODA_ENABLE
+    rds_oda_t oda[RDS_PARSER_ODA_COUNT];
+    uint8_t oda_count;
+    uint8_t rt_plus_group_id; // group carrying RT+, 0 if not registered
+    rds_rt_plus_t rt_plus;
+#endif
+#if RDS_PARSER_TMC_ENABLE
+    rds_tmc_t tmc;
+#endif
+#if RDS_PARSER_STATS_ENABLE
+    rds_parser_stats_t stats;
 #endif
 } rds_parser_t;
 
@@ -83,8 +286,46 @@ void rds_parser_reset(rds_parser_t *parser);
  * 
  * @param parser RDS parser.
  * @param group 
+ * @return Bitmask of rds_change_t flags for the fields changed by this group.
  */
-void rds_parser_update(rds_parser_t *parser, const rds_group_t *group);
+uint32_t rds_parser_update(rds_parser_t *parser, const rds_group_t *group);
+
+/**
+ * \brief Process an RDS group, ignoring corrupted blocks.
+ * 
+ * Blocks with an error level above RDS_PARSER_MAX_BLOCK_ERRORS are not used. If block B
+ * is corrupted the whole group is dropped, since the group type is unknown. Otherwise only
+ * the fields carried by the corrupted blocks are skipped.
+ * 
+ * @param parser RDS parser.
+ * @param group 
+ * @param bler Error levels for blocks A-D, e.g. from fm_get_rds_block_errors().
+ * @return Bitmask of rds_change_t flags for the fields changed by this group.
+ */
+uint32_t rds_parser_update_with_errors(rds_parser_t *parser, const rds_group_t *group, const uint8_t *bler);
+
+#if RDS_PARSER_STATS_ENABLE
+/**
+ * \brief Get a snapshot of the diagnostic counters.
+ * 
+ * Only available with RDS_PARSER_STATS_ENABLE.
+ * 
+ * @param parser RDS parser.
+ * @param stats Output counters.
+ */
+static inline void rds_parser_get_stats(const rds_parser_t *parser, rds_parser_stats_t *stats) {
+    *stats = parser->stats;
+}
+
+/**
+ * \brief Zero the diagnostic counters.
+ * 
+ * @param parser RDS parser.
+ */
+static inline void rds_parser_reset_stats(rds_parser_t *parser) {
+    parser->stats = (rds_parser_stats_t){};
+}
+#endif
 
 /**
  * \brief Get the PI code
@@ -180,6 +421,18 @@ static inline const char *rds_get_radio_text_str(const rds_parser_t *parser) {
     return parser->rt_str;
 }
 
+/**
+ * \brief Get the Radio Text received so far.
+ * 
+ * The text being assembled, before rds_get_radio_text_str() is updated. Segments not yet
+ * received are filled with spaces, and the string ends after the last received segment.
+ * Useful to show something right after tuning, when a full text takes several seconds.
+ * 
+ * @param parser 
+ * @param str Output string with capacity for at least 65 chars.
+ */
+void rds_get_radio_text_partial(const rds_parser_t *parser, char *str);
+
 /**
  * \brief Get the Radio Text A/B flag.
  * 
@@ -203,16 +456,51 @@ static inline size_t rds_get_alternative_frequency_count(const rds_parser_t *par
 /**
  * \brief Get an alternative frequency.
  * 
- * Returns the raw value. Call rds_decode_alternative_frequency() to convert into MHz.
+ * Frequencies are sorted in ascending order. Returns the raw value. Call
+ * rds_decode_alternative_frequency() to convert into MHz.
  * 
  * @param parser RDS parser.
- * @param index Frequency index.
+ * @param index Frequency index, less than rds_get_alternative_frequency_count().
  * @return Raw frequency value.
  */
-static inline uint8_t rds_get_alternative_frequency(const rds_parser_t *parser, size_t index) {
-    return parser->alt_freq[index];
+uint8_t rds_get_alternative_frequency(const rds_parser_t *parser, size_t index);
+
+/**
+ * \brief Check if a frequency has been announced as alternative.
+ * 
+ * @param parser RDS parser.
+ * @param alt_freq Raw frequency value.
+ */
+static inline bool rds_has_alternative_frequency(const rds_parser_t *parser, uint8_t alt_freq) {
+    assert(0 < alt_freq && alt_freq < 205);
+
+    return (parser->alt_freq_bitmap[alt_freq / 32] & (1u << (alt_freq % 32))) != 0;
 }
 
+/**
+ * \brief Check if an alternative frequency carries a regional variant of the program.
+ * 
+ * Only method B lists distinguish regional variants.
+ * 
+ * @param parser RDS parser.
+ * @param alt_freq Raw frequency value.
+ */
+static inline bool rds_is_alternative_frequency_regional(const rds_parser_t *parser, uint8_t alt_freq) {
+    assert(0 < alt_freq && alt_freq < 205);
+
+    return (parser->alt_freq_regional_bitmap[alt_freq / 32] & (1u << (alt_freq % 32))) != 0;
+}
+
+/**
+ * \brief Set the tuned frequency, needed to decode method B lists.
+ * 
+ * Should be called after rds_parser_reset(). Without it, all lists are decoded as method A.
+ * 
+ * @param parser RDS parser.
+ * @param frequency Tuned frequency in 10 kHz units, see fm_get_frequency_10khz().
+ */
+void rds_parser_set_tuned_frequency_10khz(rds_parser_t *parser, uint16_t frequency);
+
 /**
  * \brief Decode raw frequency value into MHz.
  * 
@@ -223,6 +511,132 @@ static inline float rds_decode_alternative_frequency(uint8_t alt_freq) {
 
     return 87.5f + alt_freq * 0.1f;
 }
+
+/**
+ * \brief Decode raw frequency value into 10 kHz units.
+ * 
+ * Same as rds_decode_alternative_frequency(), but without floating point math.
+ * 
+ * @param alt_freq Raw frequency value.
+ * @return Frequency in 10 kHz units, e.g. 8760 for 87.6 MHz.
+ */
+static inline uint16_t rds_decode_alternative_frequency_10khz(uint8_t alt_freq) {
+    assert(0 < alt_freq && alt_freq < 205);
+
+    return 8750 + alt_freq * 10;
+}
+#endif
+
+#if RDS_PARSER_CLOCK_TIME_ENABLE
+/**
+ * \brief Get the last clock time received.
+ * 
+ * @param parser RDS parser.
+ * @param clock_time Output clock time.
+ * @return true Clock time received since reset.
+ * @return false No clock time yet.
+ */
+static inline bool rds_get_clock_time(const rds_parser_t *parser, rds_clock_time_t *clock_time) {
+    *clock_time = parser->clock_time;
+    return parser->has_clock_time;
+}
+
+/**
+ * \brief Convert a Modified Julian Day to a calendar date.
+ * 
+ * See IEC 62106 annex G. Valid between March 1900 and February 2100.
+ * 
+ * @param mjd Modified Julian Day.
+ * @param year Output year, e.g. 2021.
+ * @param month Output month, 1-12.
+ * @param day Output day of month, 1-31.
+ */
+static inline void rds_decode_date(uint32_t mjd, uint16_t *year, uint8_t *month, uint8_t *day) {
+    // integer version of the annex G formulas, scaled to keep the fractional constants exact
+    uint32_t y = (mjd * 100 - 1507820) / 36525;
+    uint32_t y_days = y * 36525 / 100;
+    uint32_t m = ((mjd - 14956 - y_days) * 10000 - 1000) / 306001;
+    *day = (uint8_t)(mjd - 14956 - y_days - m * 306001 / 10000);
+    uint32_t k = (m == 14 || m == 15) ? 1 : 0;
+    *year = (uint16_t)(1900 + y + k);
+    *month = (uint8_t)(m - 1 - k * 12);
+}
+#endif
+
+#if RDS_PARSER_PTYN_ENABLE
+/**
+ * \brief Get the program type name (PTYN) string.
+ * 
+ * @param parser RDS parser.
+ */
+static inline const char *rds_get_program_type_name_str(const rds_parser_t *parser) {
+    return parser->ptyn_str;
+}
+#endif
+
+#if RDS_PARSER_EON_ENABLE
+/**
+ * \brief Get the number of other networks.
+ * 
+ * @param parser RDS parser.
+ */
+static inline size_t rds_get_eon_count(const rds_parser_t *parser) {
+    return parser->eon_count;
+}
+
+/**
+ * \brief Get an other network.
+ * 
+ * @param parser RDS parser.
+ * @param index Index, less than rds_get_eon_count().
+ */
+static inline const rds_eon_t *rds_get_eon(const rds_parser_t *parser, size_t index) {
+    assert(index < parser->eon_count);
+
+    return &parser->eon[index];
+}
+#endif
+
+#if RDS_PARSER_ODA_ENABLE
+/**
+ * \brief Find a registered open data application.
+ * 
+ * @param parser RDS parser.
+ * @param aid Application identification.
+ * @return The application, or NULL if it hasn't been announced.
+ */
+static inline const rds_oda_t *rds_find_oda(const rds_parser_t *parser, uint16_t aid) {
+    for (size_t i = 0; i < parser->oda_count; i++) {
+        if (parser->oda[i].aid == aid) {
+            return &parser->oda[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * \brief Get the radio text plus tags.
+ * 
+ * Tags refer to the radio text, see rds_get_radio_text(), which may lag behind the tags
+ * until its last segment arrives.
+ * 
+ * @param parser RDS parser.
+ * @return The tags, or NULL if the station hasn't registered RT+.
+ */
+static inline const rds_rt_plus_t *rds_get_rt_plus(const rds_parser_t *parser) {
+    return parser->rt_plus_group_id != 0 ? &parser->rt_plus : NULL;
+}
+#endif
+
+#if RDS_PARSER_TMC_ENABLE
+/**
+ * \brief Get the last TMC group.
+ * 
+ * @param parser RDS parser.
+ */
+static inline const rds_tmc_t *rds_get_tmc(const rds_parser_t *parser) {
+    return &parser->tmc;
+}
 #endif
 
 #ifdef __cplusplus
@@ -21,19 +21,40 @@ static char hex_to_char(uint8_t value) {
 // rds_group
 //
 
-typedef enum
-{
-    RDS_GROUP_BASIC = 0x00,
-    RDS_GROUP_RT = 0x02,
-} rds_group_type_t;
+#define RDS_BLOCK_A 0x1
+#define RDS_BLOCK_B 0x2
+#define RDS_BLOCK_C 0x4
+#define RDS_BLOCK_D 0x8
+#define RDS_BLOCK_ALL 0xF
+
+// group id: (type << 1) | version
+#define RDS_GROUP_ID(type, version) (((type) << 1) | (version))
+#define RDS_GROUP_0A RDS_GROUP_ID(0, 0)
+#define RDS_GROUP_0B RDS_GROUP_ID(0, 1)
+#define RDS_GROUP_2A RDS_GROUP_ID(2, 0)
+#define RDS_GROUP_2B RDS_GROUP_ID(2, 1)
+#define RDS_GROUP_3A RDS_GROUP_ID(3, 0)
+#define RDS_GROUP_4A RDS_GROUP_ID(4, 0)
+#define RDS_GROUP_8A RDS_GROUP_ID(8, 0)
+#define RDS_GROUP_10A RDS_GROUP_ID(10, 0)
+#define RDS_GROUP_14A RDS_GROUP_ID(14, 0)
+#define RDS_GROUP_14B RDS_GROUP_ID(14, 1)
+
+#define RDS_AID_RT_PLUS 0x4BD7
 
 static uint16_t rds_get_group_pi(const rds_group_t *group) {
     return group->a;
 }
 
-static rds_group_type_t rds_get_group_type(const rds_group_t *group) {
+#if RDS_PARSER_STATS_ENABLE
+static uint8_t rds_get_group_type(const rds_group_t *group) {
     return group->b >> 12;
 }
+#endif
+
+static uint8_t rds_get_group_id(const rds_group_t *group) {
+    return group->b >> 11;
+}
 
 static uint8_t rds_get_group_version(const rds_group_t *group) {
     return (group->b >> 11) & 0x01;
@@ -51,22 +72,42 @@ static uint8_t rds_get_group_pty(const rds_group_t *group) {
 // rds_parser_t
 //
 
-static void rds_parse_group_basic_ps(rds_parser_t *parser, const rds_group_t *group) {
+static uint32_t rds_parse_group_basic_ps(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    if (!(valid_blocks & RDS_BLOCK_D)) {
+        return 0;
+    }
+
     // group 0A / 0B
     size_t address = group->b & 0x3;
-    size_t char_index = 2 * address;
     char ch0 = group->d >> 8;
     char ch1 = group->d & 0xFF;
-    parser->ps_scratch_str[char_index] = ch0;
-    parser->ps_scratch_str[char_index + 1] = ch1;
+    char *chars = parser->ps_scratch_str + 2 * address;
+    uint8_t *hits = &parser->ps_segment_hits[address];
+    if (chars[0] == ch0 && chars[1] == ch1 && *hits != 0) {
+        if (*hits < RDS_PARSER_PS_MIN_HITS) {
+            (*hits)++;
+        }
+    } else {
+        // new or conflicting segment, start voting over
+        chars[0] = ch0;
+        chars[1] = ch1;
+        *hits = 1;
+    }
 
-    bool finished = (address == 3);
-    if (finished) {
+    // publish once every segment has been confirmed, in whatever order they arrived
+    for (size_t i = 0; i < 4; i++) {
+        if (parser->ps_segment_hits[i] < RDS_PARSER_PS_MIN_HITS) {
+            return 0;
+        }
+    }
+    if (memcmp(parser->ps_str, parser->ps_scratch_str, 8) != 0) {
         memcpy(parser->ps_str, parser->ps_scratch_str, 8);
+        return RDS_CHANGE_PS;
     }
+    return 0;
 }
 
-static void rds_parse_group_basic_di(rds_parser_t *parser, const rds_group_t *group) {
+static uint32_t rds_parse_group_basic_di(rds_parser_t *parser, const rds_group_t *group) {
     // group 0A / 0B
     size_t di_bit_index = ~group->b & 0x3;
     uint8_t di_bit = (group->b >> 2) & 0x1;
@@ -74,119 +115,497 @@ static void rds_parse_group_basic_di(rds_parser_t *parser, const rds_group_t *gr
     parser->di_scratch |= di_bit << di_bit_index;
 
     bool finished = (di_bit_index == 0);
-    if (finished) {
+    if (finished && parser->di != parser->di_scratch) {
         parser->di = parser->di_scratch;
+        return RDS_CHANGE_DI;
     }
+    return 0;
 }
 
 #if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
-static void rds_add_alt_freq(rds_parser_t *parser, uint8_t alt_freq) {
-    if (alt_freq == 0 || 205 <= alt_freq) {
-        return; // out of range, ignored
+#define RDS_AF_FILLER 205
+#define RDS_AF_COUNT_FIRST 224 // list of 0 frequencies
+#define RDS_AF_COUNT_LAST 249 // list of 25 frequencies
+#define RDS_AF_LF_MF 250 // LF / MF frequency follows
+
+static uint32_t rds_add_alt_freq(rds_parser_t *parser, uint8_t alt_freq, bool regional) {
+    if (alt_freq == 0 || RDS_AF_FILLER <= alt_freq) {
+        return 0; // not a VHF frequency, ignored
     }
-    if (parser->alt_freq_count == sizeof(parser->alt_freq)) {
-        return; // list full, ignored
+    uint32_t changes = 0;
+    uint32_t bit = 1u << (alt_freq % 32);
+    uint32_t *word = &parser->alt_freq_bitmap[alt_freq / 32];
+    if (!(*word & bit)) {
+        *word |= bit;
+        parser->alt_freq_count++;
+        changes = RDS_CHANGE_AF;
     }
-    for (size_t i = 0; i < parser->alt_freq_count; i++) {
-        if (parser->alt_freq[i] == alt_freq) {
-            return; // duplicate, ignored
-        }
+    uint32_t *regional_word = &parser->alt_freq_regional_bitmap[alt_freq / 32];
+    if (regional && !(*regional_word & bit)) {
+        *regional_word |= bit;
+        changes = RDS_CHANGE_AF;
     }
-    parser->alt_freq[parser->alt_freq_count++] = alt_freq;
+    return changes;
 }
 
-static void rds_parse_group_basic_alt_freq(rds_parser_t *parser, const rds_group_t *group) {
+static uint32_t rds_parse_group_basic_alt_freq(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
     uint8_t version = rds_get_group_version(group);
-    if (version != 0) {
-        return;
+    if (version != 0 || !(valid_blocks & RDS_BLOCK_C)) {
+        return 0;
     }
     // group 0A
     uint8_t f0 = group->c >> 8;
     uint8_t f1 = group->c & 0xFF;
-    rds_add_alt_freq(parser, f0);
-    rds_add_alt_freq(parser, f1);
+    if (RDS_AF_COUNT_FIRST <= f0 && f0 <= RDS_AF_COUNT_LAST) {
+        // start of list, method B lists begin with the tuned frequency
+        uint8_t count = f0 - RDS_AF_COUNT_FIRST;
+        parser->alt_freq_method_b = (1 < count && f1 == parser->alt_freq_tuned && f1 != 0);
+        if (!parser->alt_freq_method_b) {
+            return rds_add_alt_freq(parser, f1, false);
+        }
+        return 0;
+    }
+    if (f0 == RDS_AF_LF_MF) {
+        return 0; // LF / MF, not supported
+    }
+    if (parser->alt_freq_method_b) {
+        uint8_t tuned = parser->alt_freq_tuned;
+        if (f0 == tuned || f1 == tuned) {
+            // ascending pair: same program, descending pair: regional variant
+            uint8_t alt_freq = (f0 == tuned) ? f1 : f0;
+            return rds_add_alt_freq(parser, alt_freq, f1 < f0);
+        }
+        parser->alt_freq_method_b = false; // not a method B list after all
+    }
+    return rds_add_alt_freq(parser, f0, false) | rds_add_alt_freq(parser, f1, false);
 }
 #endif // RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
 
-static void rds_parse_group_basic(rds_parser_t *parser, const rds_group_t *group) {
-    rds_parse_group_basic_ps(parser, group);
-    rds_parse_group_basic_di(parser, group);
+static uint32_t rds_parse_group_basic(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    uint32_t changes = 0;
+    bool ta = ((group->b >> 4) & 0x1) != 0;
+    if (parser->ta != ta) {
+        parser->ta = ta;
+        changes |= RDS_CHANGE_TA;
+    }
+    bool ms = ((group->b >> 3) & 0x1) != 0;
+    if (parser->ms != ms) {
+        parser->ms = ms;
+        changes |= RDS_CHANGE_MS;
+    }
+    changes |= rds_parse_group_basic_ps(parser, group, valid_blocks);
+    changes |= rds_parse_group_basic_di(parser, group);
 #if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
-    rds_parse_group_basic_alt_freq(parser, group);
+    changes |= rds_parse_group_basic_alt_freq(parser, group, valid_blocks);
 #endif
+    return changes;
 }
 
 #if RDS_PARSER_RADIO_TEXT_ENABLE
-static void rds_parse_group_rt(rds_parser_t *parser, const rds_group_t *group) {
+static uint32_t rds_parse_group_rt(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
     uint8_t version = rds_get_group_version(group);
+    uint8_t required_blocks = (version == 0 ? RDS_BLOCK_C | RDS_BLOCK_D : RDS_BLOCK_D);
+    if ((valid_blocks & required_blocks) != required_blocks) {
+        return 0; // text would be garbled
+    }
     size_t address = group->b & 0xF;
-    parser->rt_scratch_a_b = (group->b >> 4) & 0x1;
+    bool a_b = (group->b >> 4) & 0x1;
+    bool is_2b = (version != 0);
+    if (parser->rt_scratch_a_b != a_b || parser->rt_scratch_2b != is_2b) {
+        // text changed, segments of the old one are useless
+        memset(parser->rt_scratch_str, 0, sizeof(parser->rt_scratch_str));
+        parser->rt_scratch_a_b = a_b;
+        parser->rt_scratch_2b = is_2b;
+        parser->rt_scratch_segments = 0;
+        parser->rt_scratch_end = 0;
+    }
 
     char chars[4];
     size_t char_count;
-    size_t char_index;
     if (version == 0) { // group 2A
         chars[0] = group->c >> 8;
         chars[1] = group->c & 0xFF;
         chars[2] = group->d >> 8;
         chars[3] = group->d & 0xFF;
         char_count = 4;
-        char_index = address * 4;
     } else { // group 2B
         chars[0] = group->d >> 8;
         chars[1] = group->d & 0xFF;
         char_count = 2;
-        char_index = address * 2;
     }
 
-    bool finished = false;
     for (size_t i = 0; i < char_count; i++) {
-        char ch = chars[i];
-        if (ch == '\r') {
-            parser->rt_scratch_str[char_index++] = '\0';
-            finished = true;
+        if (chars[i] == '\r') {
+            memset(chars + i, 0, char_count - i);
+            parser->rt_scratch_end = (uint8_t)(address + 1);
             break;
         }
-        parser->rt_scratch_str[char_index++] = ch;
-        if (char_index == 64) {
-            finished = true;
+    }
+    char *dst = parser->rt_scratch_str + address * char_count;
+    uint16_t segment_bit = 1u << address;
+    bool segment_changed = !(parser->rt_scratch_segments & segment_bit) || memcmp(dst, chars, char_count) != 0;
+    memcpy(dst, chars, char_count);
+    parser->rt_scratch_segments |= segment_bit;
+    uint32_t changes = segment_changed ? RDS_CHANGE_RT_PARTIAL : 0;
+
+    // complete when all segments up to the terminator are in, or all 16 without one
+    size_t end = (parser->rt_scratch_end != 0 ? parser->rt_scratch_end : 16);
+    uint16_t required = (uint16_t)((1u << end) - 1);
+    if ((parser->rt_scratch_segments & required) != required) {
+        return changes;
+    }
+    if (memcmp(parser->rt_str, parser->rt_scratch_str, 64) == 0 && parser->rt_a_b == parser->rt_scratch_a_b) {
+        return changes; // repeated
+    }
+    memcpy(parser->rt_str, parser->rt_scratch_str, 64);
+    parser->rt_a_b = parser->rt_scratch_a_b;
+    return changes | RDS_CHANGE_RT;
+}
+#endif // RDS_PARSER_RADIO_TEXT_ENABLE
+
+#if RDS_PARSER_ODA_ENABLE
+static uint32_t rds_parse_group_oda(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // group 3A - application group type in block B, message in C, AID in D
+    if ((valid_blocks & (RDS_BLOCK_C | RDS_BLOCK_D)) != (RDS_BLOCK_C | RDS_BLOCK_D)) {
+        return 0;
+    }
+    uint16_t aid = group->d;
+    if (aid == RDS_AID_RT_PLUS) {
+        parser->rt_plus_group_id = group->b & 0x1F; // 0 if not carried in a group
+    }
+    rds_oda_t *oda = NULL;
+    for (size_t i = 0; i < parser->oda_count; i++) {
+        if (parser->oda[i].aid == aid) {
+            oda = &parser->oda[i];
             break;
         }
     }
-    if (finished) {
-        memcpy(parser->rt_str, parser->rt_scratch_str, 64);
-        parser->rt_a_b = parser->rt_scratch_a_b;
+    if (oda == NULL) {
+        if (parser->oda_count == RDS_PARSER_ODA_COUNT) {
+            return 0; // list full, ignored
+        }
+        oda = &parser->oda[parser->oda_count++];
+        oda->aid = aid;
+        oda->group_id = 0xFF; // not a valid group id, so the registration is reported
+    }
+    uint8_t group_id = group->b & 0x1F;
+    if (oda->group_id == group_id && oda->message == group->c) {
+        return 0;
     }
+    oda->group_id = group_id;
+    oda->message = group->c;
+    return RDS_CHANGE_ODA;
+}
+
+static uint32_t rds_parse_group_rt_plus(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // toggle, running and 6 bit content type, start and length of two tags across blocks B to D
+    if ((valid_blocks & (RDS_BLOCK_C | RDS_BLOCK_D)) != (RDS_BLOCK_C | RDS_BLOCK_D)) {
+        return 0; // tags span both blocks
+    }
+    rds_rt_plus_t rt_plus = {
+        .tags = {
+            {
+                .content_type = ((group->b & 0x7) << 3) | (group->c >> 13),
+                .start = (group->c >> 7) & 0x3F,
+                .length = ((group->c >> 1) & 0x3F) + 1,
+            },
+            {
+                .content_type = ((group->c & 0x1) << 5) | (group->d >> 11),
+                .start = (group->d >> 5) & 0x3F,
+                .length = (group->d & 0x1F) + 1,
+            },
+        },
+        .item_toggle = ((group->b >> 4) & 0x1) != 0,
+        .item_running = ((group->b >> 3) & 0x1) != 0,
+    };
+    if (memcmp(&parser->rt_plus, &rt_plus, sizeof(rds_rt_plus_t)) == 0) {
+        return 0; // repeated
+    }
+    parser->rt_plus = rt_plus;
+    return RDS_CHANGE_RT_PLUS;
+}
+#endif // RDS_PARSER_ODA_ENABLE
+
+#if RDS_PARSER_CLOCK_TIME_ENABLE
+static uint32_t rds_parse_group_clock_time(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // group 4A
+    if ((valid_blocks & (RDS_BLOCK_C | RDS_BLOCK_D)) != (RDS_BLOCK_C | RDS_BLOCK_D)) {
+        return 0; // a partial time would be wrong
+    }
+    rds_clock_time_t *clock_time = &parser->clock_time;
+    clock_time->mjd = ((uint32_t)(group->b & 0x3) << 15) | (group->c >> 1);
+    clock_time->hour = ((group->c & 0x1) << 4) | (group->d >> 12);
+    clock_time->minute = (group->d >> 6) & 0x3F;
+    int8_t offset = group->d & 0x1F;
+    clock_time->utc_offset = ((group->d >> 5) & 0x1) ? -offset : offset;
+    parser->has_clock_time = true;
+    return RDS_CHANGE_CLOCK_TIME; // sent once a minute
+}
+#endif // RDS_PARSER_CLOCK_TIME_ENABLE
+
+#if RDS_PARSER_TMC_ENABLE
+static uint32_t rds_parse_group_tmc(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // group 8A
+    if ((valid_blocks & (RDS_BLOCK_C | RDS_BLOCK_D)) != (RDS_BLOCK_C | RDS_BLOCK_D)) {
+        return 0;
+    }
+    rds_tmc_t *tmc = &parser->tmc;
+    tmc->x = group->b & 0x1F;
+    tmc->y = group->c;
+    tmc->z = group->d;
+    tmc->count++;
+    return RDS_CHANGE_TMC;
+}
+#endif // RDS_PARSER_TMC_ENABLE
+
+#if RDS_PARSER_PTYN_ENABLE
+static uint32_t rds_parse_group_ptyn(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // group 10A
+    if ((valid_blocks & (RDS_BLOCK_C | RDS_BLOCK_D)) != (RDS_BLOCK_C | RDS_BLOCK_D)) {
+        return 0;
+    }
+    bool a_b = (group->b >> 4) & 0x1;
+    if (a_b != parser->ptyn_a_b) {
+        // name changed, clear scratch
+        memset(parser->ptyn_scratch_str, ' ', 8);
+        parser->ptyn_a_b = a_b;
+        parser->ptyn_scratch_segments = 0;
+    }
+    size_t address = group->b & 0x1;
+    char *chars = parser->ptyn_scratch_str + address * 4;
+    chars[0] = group->c >> 8;
+    chars[1] = group->c & 0xFF;
+    chars[2] = group->d >> 8;
+    chars[3] = group->d & 0xFF;
+    parser->ptyn_scratch_segments |= 1 << address;
+
+    // both halves must be in, or a half-stale name would be committed
+    bool finished = (parser->ptyn_scratch_segments == 0x3);
+    if (finished && memcmp(parser->ptyn_str, parser->ptyn_scratch_str, 8) != 0) {
+        memcpy(parser->ptyn_str, parser->ptyn_scratch_str, 8);
+        return RDS_CHANGE_PTYN;
+    }
+    return 0;
+}
+#endif // RDS_PARSER_PTYN_ENABLE
+
+#if RDS_PARSER_EON_ENABLE
+static rds_eon_t *rds_get_or_add_eon(rds_parser_t *parser, uint16_t pi, uint32_t *changes) {
+    for (size_t i = 0; i < parser->eon_count; i++) {
+        if (parser->eon[i].pi == pi) {
+            return &parser->eon[i];
+        }
+    }
+    if (parser->eon_count == RDS_PARSER_EON_COUNT) {
+        return NULL; // list full
+    }
+    rds_eon_t *eon = &parser->eon[parser->eon_count++];
+    memset(eon, 0, sizeof(rds_eon_t));
+    eon->pi = pi;
+    *changes = RDS_CHANGE_EON;
+    return eon;
+}
+
+static uint32_t rds_update_eon_flag(bool *flag, bool value) {
+    if (*flag == value) {
+        return 0;
+    }
+    *flag = value;
+    return RDS_CHANGE_EON;
+}
+
+static uint32_t rds_parse_group_eon(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+    // group 14A / 14B - PI of the other network in block D
+    if (!(valid_blocks & RDS_BLOCK_D)) {
+        return 0;
+    }
+    uint32_t changes = 0;
+    rds_eon_t *eon = rds_get_or_add_eon(parser, group->d, &changes);
+    if (eon == NULL) {
+        return 0; // list full, ignored
+    }
+    changes |= rds_update_eon_flag(&eon->tp, ((group->b >> 4) & 0x1) != 0);
+    if (rds_get_group_version(group) != 0) {
+        // 14B - switching signal for a traffic announcement
+        return changes | rds_update_eon_flag(&eon->ta, ((group->b >> 3) & 0x1) != 0);
+    }
+    // 14A - variant in block B, information in C
+    if (!(valid_blocks & RDS_BLOCK_C)) {
+        return changes;
+    }
+    uint8_t variant = group->b & 0xF;
+    if (variant < 4) {
+        // PS name segment
+        char ch0 = group->c >> 8;
+        char ch1 = group->c & 0xFF;
+        char *chars = eon->ps_str + variant * 2;
+        if (chars[0] != ch0 || chars[1] != ch1) {
+            chars[0] = ch0;
+            chars[1] = ch1;
+            changes |= RDS_CHANGE_EON;
+        }
+    } else if (variant == 13) {
+        changes |= rds_update_eon_flag(&eon->ta, (group->c & 0x1) != 0);
+    }
+    return changes;
+}
+#endif // RDS_PARSER_EON_ENABLE
+
+typedef uint32_t (*rds_group_handler_t)(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks);
+
+// indexed by group id, NULL for groups that aren't decoded
+static const rds_group_handler_t RDS_GROUP_HANDLERS[32] = {
+    [RDS_GROUP_0A] = rds_parse_group_basic,
+    [RDS_GROUP_0B] = rds_parse_group_basic,
+#if RDS_PARSER_RADIO_TEXT_ENABLE
+    [RDS_GROUP_2A] = rds_parse_group_rt,
+    [RDS_GROUP_2B] = rds_parse_group_rt,
+#endif
+#if RDS_PARSER_ODA_ENABLE
+    [RDS_GROUP_3A] = rds_parse_group_oda,
+#endif
+#if RDS_PARSER_CLOCK_TIME_ENABLE
+    [RDS_GROUP_4A] = rds_parse_group_clock_time,
+#endif
+#if RDS_PARSER_TMC_ENABLE
+    [RDS_GROUP_8A] = rds_parse_group_tmc,
+#endif
+#if RDS_PARSER_PTYN_ENABLE
+    [RDS_GROUP_10A] = rds_parse_group_ptyn,
+#endif
+#if RDS_PARSER_EON_ENABLE
+    [RDS_GROUP_14A] = rds_parse_group_eon,
+    [RDS_GROUP_14B] = rds_parse_group_eon,
+#endif
+};
+
+static uint32_t rds_parser_update_blocks(rds_parser_t *parser, const rds_group_t *group, uint8_t valid_blocks) {
+#if RDS_PARSER_STATS_ENABLE
+    parser->stats.groups++;
+    parser->stats.blocks_rejected += 4 - __builtin_popcount(valid_blocks);
+    if (!(valid_blocks & RDS_BLOCK_B)) {
+        parser->stats.groups_rejected++;
+    } else {
+        parser->stats.group_types[rds_get_group_type(group)]++;
+    }
+#endif
+    // PI doesn't depend on the group type, and version B groups repeat it in block C
+    uint32_t changes = 0;
+    bool has_pi = (valid_blocks & RDS_BLOCK_A) != 0;
+    uint16_t pi = rds_get_group_pi(group);
+    if (!has_pi && (valid_blocks & (RDS_BLOCK_B | RDS_BLOCK_C)) == (RDS_BLOCK_B | RDS_BLOCK_C)
+        && rds_get_group_version(group) != 0) {
+        has_pi = true;
+        pi = group->c;
+    }
+    if (has_pi && parser->pi != pi) {
+        parser->pi = pi;
+        changes |= RDS_CHANGE_PI;
+    }
+    if (!(valid_blocks & RDS_BLOCK_B)) {
+        return changes; // group type unknown
+    }
+    uint8_t pty = rds_get_group_pty(group);
+    if (parser->pty != pty) {
+        parser->pty = pty;
+        changes |= RDS_CHANGE_PTY;
+    }
+    bool tp = rds_get_group_tp(group);
+    if (parser->tp != tp) {
+        parser->tp = tp;
+        changes |= RDS_CHANGE_TP;
+    }
+
+    rds_group_handler_t handler = RDS_GROUP_HANDLERS[rds_get_group_id(group)];
+    if (handler != NULL) {
+        changes |= handler(parser, group, valid_blocks);
+    }
+#if RDS_PARSER_ODA_ENABLE
+    // the RT+ carrier group is assigned by the station, so it can't be in the table
+    if (parser->rt_plus_group_id != 0 && rds_get_group_id(group) == parser->rt_plus_group_id) {
+        changes |= rds_parse_group_rt_plus(parser, group, valid_blocks);
+    }
+#endif
+    return changes;
 }
-#endif // RDS_PARSER_RADIO_TEXT_ENABLE
 
 //
 // public interface
 //
 
 void rds_parser_reset(rds_parser_t *parser) {
+#if RDS_PARSER_STATS_ENABLE
+    rds_parser_stats_t stats = parser->stats;
     memset(parser, 0, sizeof(rds_parser_t));
+    parser->stats = stats;
+#else
+    memset(parser, 0, sizeof(rds_parser_t));
+#endif
+#if RDS_PARSER_PTYN_ENABLE
+    memset(parser->ptyn_scratch_str, ' ', 8);
+#endif
 }
 
-void rds_parser_update(rds_parser_t *parser, const rds_group_t *group) {
-    parser->pi = rds_get_group_pi(group);
-    parser->pty = rds_get_group_pty(group);
-    parser->tp = rds_get_group_tp(group);
+uint32_t rds_parser_update(rds_parser_t *parser, const rds_group_t *group) {
+    return rds_parser_update_blocks(parser, group, RDS_BLOCK_ALL);
+}
+
+uint32_t rds_parser_update_with_errors(rds_parser_t *parser, const rds_group_t *group, const uint8_t *bler) {
+    uint8_t valid_blocks = 0;
+    for (size_t i = 0; i < 4; i++) {
+        if (bler[i] <= RDS_PARSER_MAX_BLOCK_ERRORS) {
+            valid_blocks |= 1 << i;
+        }
+    }
+    return rds_parser_update_blocks(parser, group, valid_blocks);
+}
 
-    switch (rds_get_group_type(group)) {
-    case RDS_GROUP_BASIC:
-        rds_parse_group_basic(parser, group);
-        break;
 #if RDS_PARSER_RADIO_TEXT_ENABLE
-    case RDS_GROUP_RT:
-        rds_parse_group_rt(parser, group);
-        break;
+void rds_get_radio_text_partial(const rds_parser_t *parser, char *str) {
+    size_t segment_length = (parser->rt_scratch_2b ? 2 : 4);
+    size_t length = 0;
+    for (size_t i = 0; i < 16; i++) {
+        if (!(parser->rt_scratch_segments & (1u << i))) {
+            memset(str + i * segment_length, ' ', segment_length);
+            continue;
+        }
+        const char *src = parser->rt_scratch_str + i * segment_length;
+        memcpy(str + i * segment_length, src, segment_length);
+        const char *terminator = memchr(src, '\0', segment_length);
+        length = i * segment_length + (terminator != NULL ? (size_t)(terminator - src) : segment_length);
+        if (parser->rt_scratch_end == i + 1) {
+            break;
+        }
+    }
+    str[length] = '\0';
+}
 #endif
-    default:
-        break;
+
+#if RDS_PARSER_ALTERNATIVE_FREQUENCIES_ENABLE
+uint8_t rds_get_alternative_frequency(const rds_parser_t *parser, size_t index) {
+    assert(index < parser->alt_freq_count);
+
+    for (size_t i = 0; i < 7; i++) {
+        uint32_t word = parser->alt_freq_bitmap[i];
+        size_t count = __builtin_popcount(word);
+        if (index < count) {
+            // drop lower set bits until the wanted one is lowest
+            for (; index != 0; index--) {
+                word &= word - 1;
+            }
+            return (uint8_t)(i * 32 + __builtin_ctz(word));
+        }
+        index -= count;
     }
+    return 0;
 }
 
+void rds_parser_set_tuned_frequency_10khz(rds_parser_t *parser, uint16_t frequency) {
+    bool in_range = (8760 <= frequency && frequency <= 10790 && frequency % 10 == 0); // AFs are on a 100 kHz grid
+    parser->alt_freq_tuned = in_range ? (uint8_t)((frequency - 8750) / 10) : 0;
+}
+#endif
+
 void rds_get_program_id_as_str(const rds_parser_t *parser, char *str) {
     str[0] = hex_to_char(parser->pi >> 12);
     str[1] = hex_to_char((parser->pi >> 8) & 0xF);